@@ -44,5 +44,10 @@ namespace config
 		constexpr auto serial_priority = K_PRIO_PREEMPT(5);
 		constexpr auto serial_stack_size = K_THREAD_STACK_LEN(2048);
 		inline k_thread_stack_t serial_stack[serial_stack_size];
+
+		/* Position persistence runs below everything user-facing. */
+		constexpr auto persistence_priority = K_PRIO_PREEMPT(7);
+		constexpr auto persistence_stack_size = K_THREAD_STACK_LEN(1024);
+		inline k_thread_stack_t persistence_stack[persistence_stack_size];
 	} // namespace threads
 } // namespace config
\ No newline at end of file
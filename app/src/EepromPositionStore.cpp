@@ -4,9 +4,13 @@
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/eeprom.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/sys/util.h>
 
-LOG_MODULE_REGISTER(position_store, CONFIG_APP_LOG_LEVEL);
+#include <algorithm>
+#include <array>
+
+LOG_MODULE_DECLARE(position_store, CONFIG_APP_LOG_LEVEL);
 
 namespace
 {
@@ -19,7 +23,34 @@ const struct device *const k_eeprom = DEVICE_DT_GET(FOCUSER_EEPROM_NODE);
 #endif
 
 constexpr uint32_t kPositionMagic = 0x464F4350U; // "FOCP"
-constexpr off_t kPositionOffset = 0;
+constexpr off_t kLegacyOffset = 0;
+constexpr uint32_t kErasedSequence = 0xFFFFFFFFU;
+constexpr uint8_t kErasedByte = 0xFFU;
+constexpr size_t kRecordSize = sizeof(EepromPositionStore::JournalRecord);
+/* Erase in large, aligned chunks: on flash-backed EEPROM every write that has
+ * to set bits costs a page erase, so small chunks multiply the erase count.
+ */
+constexpr size_t kEraseChunk = 256U;
+constexpr auto kErasedChunk = [] {
+	std::array<uint8_t, kEraseChunk> bytes{};
+	bytes.fill(kErasedByte);
+	return bytes;
+}();
+
+static_assert(kRecordSize == 16U, "journal records must stay packed");
+static_assert(sizeof(EepromPositionStore::LegacyRecord) == 8U,
+	      "legacy record occupies the first 8 bytes");
+
+off_t slot_offset(size_t slot)
+{
+	return static_cast<off_t>(slot * kRecordSize);
+}
+
+bool is_valid(const EepromPositionStore::JournalRecord &record)
+{
+	return (record.sequence != kErasedSequence) &&
+	       (record.crc == EepromPositionStore::journal_crc(record));
+}
 
 } // namespace
 
@@ -27,10 +58,16 @@ EepromPositionStore::EepromPositionStore()
 {
 }
 
-bool EepromPositionStore::load(uint16_t &position_out)
+uint16_t EepromPositionStore::journal_crc(const JournalRecord &record)
+{
+	return crc16_ccitt(0xFFFFU, reinterpret_cast<const uint8_t *>(&record),
+			   offsetof(JournalRecord, crc));
+}
+
+bool EepromPositionStore::load(PersistentState &state_out)
 {
 #ifndef FOCUSER_EEPROM_NODE
-	ARG_UNUSED(position_out);
+	ARG_UNUSED(state_out);
 	return false;
 #else
 	if (!ensure_ready())
@@ -38,58 +75,81 @@ bool EepromPositionStore::load(uint16_t &position_out)
 		return false;
 	}
 
-	PositionRecord record{};
-	const int ret = eeprom_read(k_eeprom, kPositionOffset, &record, sizeof(record));
-	if (ret != 0)
+	m_scanned = true;
+	JournalRecord newest{};
+	size_t slot = 0U;
+	if (find_newest(newest, slot) &&
+	    persistent_state::decode(newest.payload, newest.length, state_out))
 	{
-		LOG_WRN("Failed to read position from EEPROM (%d)", ret);
-		return false;
+		m_next_slot = slot + 1U;
+		m_next_sequence = newest.sequence + 1U;
 	}
-
-	if ((record.magic != kPositionMagic) || (record.checksum != checksum(record.position)))
+	else
 	{
-		return false;
+		m_next_slot = 0U;
+		m_next_sequence = 0U;
+		if (!load_legacy(state_out))
+		{
+			return false;
+		}
+		/* Start the first save with a compaction so the legacy record is
+		 * cleared instead of lingering behind the new journal.
+		 */
+		m_next_slot = m_slot_count;
 	}
 
-	position_out = record.position;
-	m_last_value = record.position;
+	m_last_state = state_out;
 	m_has_value = true;
 	return true;
 #endif
 }
 
-void EepromPositionStore::save(uint16_t position)
+void EepromPositionStore::save(const PersistentState &state)
 {
 #ifndef FOCUSER_EEPROM_NODE
-	ARG_UNUSED(position);
+	ARG_UNUSED(state);
 	return;
 #else
-	if (m_has_value && (position == m_last_value))
+	if (m_has_value && (state == m_last_state))
 	{
 		return;
 	}
 
-	if (!ensure_ready())
+	if (!ensure_ready() || !ensure_scanned())
 	{
 		return;
 	}
 
-	PositionRecord record{
-		.magic = kPositionMagic,
-		.position = position,
-		.checksum = checksum(position),
-	};
+	JournalRecord record{};
+	record.sequence = m_next_sequence;
+	record.version = persistent_state::kVersion;
+	record.length = persistent_state::encode(state, record.payload);
+	record.crc = journal_crc(record);
 
-	const int ret = eeprom_write(k_eeprom, kPositionOffset, &record, sizeof(record));
-	if (ret != 0)
+	if (m_next_slot >= m_slot_count)
 	{
-		LOG_ERR("Failed to save position to EEPROM (%d)", ret);
-		return;
+		if (!compact(record))
+		{
+			return;
+		}
+	}
+	else
+	{
+		const int ret = eeprom_write(k_eeprom, slot_offset(m_next_slot), &record,
+					     sizeof(record));
+		if (ret != 0)
+		{
+			LOG_ERR("Failed to save state to EEPROM (%d)", ret);
+			return;
+		}
+		++m_next_slot;
 	}
 
-	m_last_value = position;
+	++m_next_sequence;
+	m_last_state = state;
 	m_has_value = true;
-	LOG_DBG("Saved focuser position 0x%04x (%u) to EEPROM", position, position);
+	LOG_DBG("Saved focuser position 0x%04x (%u) to EEPROM slot %zu", state.position,
+		state.position, m_next_slot - 1U);
 #endif
 }
 
@@ -107,9 +167,10 @@ bool EepromPositionStore::ensure_ready()
 		}
 
 		m_eeprom_size = eeprom_get_size(k_eeprom);
-		if (m_eeprom_size < sizeof(PositionRecord))
+		m_slot_count = m_eeprom_size / kRecordSize;
+		if (m_slot_count < 2U)
 		{
-			LOG_ERR("EEPROM too small (%zu < %zu)", m_eeprom_size, sizeof(PositionRecord));
+			LOG_ERR("EEPROM too small (%zu < %zu)", m_eeprom_size, 2U * kRecordSize);
 			return false;
 		}
 
@@ -120,6 +181,177 @@ bool EepromPositionStore::ensure_ready()
 #endif
 }
 
+bool EepromPositionStore::ensure_scanned()
+{
+	if (!m_scanned)
+	{
+		PersistentState state{};
+		if (!load(state) && !m_scanned)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool EepromPositionStore::read_slot(size_t slot, JournalRecord &record_out) const
+{
+#ifndef FOCUSER_EEPROM_NODE
+	ARG_UNUSED(slot);
+	ARG_UNUSED(record_out);
+	return false;
+#else
+	const int ret =
+		eeprom_read(k_eeprom, slot_offset(slot), &record_out, sizeof(record_out));
+	if (ret != 0)
+	{
+		LOG_WRN("Failed to read EEPROM slot %zu (%d)", slot, ret);
+		return false;
+	}
+
+	return is_valid(record_out);
+#endif
+}
+
+bool EepromPositionStore::find_newest(JournalRecord &newest_out, size_t &slot_out) const
+{
+	/* Records are appended from slot 0 with consecutive sequence numbers, so
+	 * slot i of the current pass holds first.sequence + i. Everything past the
+	 * newest record is either erased or left over from the previous pass, which
+	 * makes the newest slot the end of a prefix that can be binary searched.
+	 */
+	JournalRecord first{};
+	if (read_slot(0U, first))
+	{
+		size_t low = 0U;
+		size_t high = m_slot_count;
+		newest_out = first;
+		while ((high - low) > 1U)
+		{
+			const size_t mid = low + ((high - low) / 2U);
+			JournalRecord record{};
+			if (read_slot(mid, record) && (record.sequence == (first.sequence + mid)))
+			{
+				low = mid;
+				newest_out = record;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+
+		slot_out = low;
+		return true;
+	}
+
+	/* Slot 0 is blank or torn (first boot, or power lost during compaction):
+	 * fall back to picking the highest sequence number anywhere in the log.
+	 */
+	bool found = false;
+	for (size_t slot = 1U; slot < m_slot_count; ++slot)
+	{
+		JournalRecord record{};
+		if (read_slot(slot, record) && (!found || (record.sequence > newest_out.sequence)))
+		{
+			newest_out = record;
+			slot_out = slot;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+bool EepromPositionStore::load_legacy(PersistentState &state_out) const
+{
+#ifndef FOCUSER_EEPROM_NODE
+	ARG_UNUSED(state_out);
+	return false;
+#else
+	/* Earlier firmware kept only the position, in a single record at
+	 * offset 0; the settings keep their defaults.
+	 */
+	LegacyRecord record{};
+	const int ret = eeprom_read(k_eeprom, kLegacyOffset, &record, sizeof(record));
+	if (ret != 0)
+	{
+		LOG_WRN("Failed to read position from EEPROM (%d)", ret);
+		return false;
+	}
+
+	if ((record.magic != kPositionMagic) || (record.checksum != checksum(record.position)))
+	{
+		return false;
+	}
+
+	LOG_INF("Migrating legacy EEPROM position record");
+	state_out = PersistentState{};
+	state_out.position = record.position;
+	return true;
+#endif
+}
+
+bool EepromPositionStore::erase_slots(size_t first, size_t count) const
+{
+#ifndef FOCUSER_EEPROM_NODE
+	ARG_UNUSED(first);
+	ARG_UNUSED(count);
+	return false;
+#else
+	size_t offset = static_cast<size_t>(slot_offset(first));
+	const size_t end = static_cast<size_t>(slot_offset(first + count));
+	while (offset < end)
+	{
+		const size_t chunk = std::min(kEraseChunk - (offset % kEraseChunk), end - offset);
+		const int ret =
+			eeprom_write(k_eeprom, static_cast<off_t>(offset), kErasedChunk.data(), chunk);
+		if (ret != 0)
+		{
+			LOG_ERR("Failed to erase EEPROM log (%d)", ret);
+			return false;
+		}
+		offset += chunk;
+	}
+
+	return true;
+#endif
+}
+
+bool EepromPositionStore::compact(const JournalRecord &record)
+{
+#ifndef FOCUSER_EEPROM_NODE
+	ARG_UNUSED(record);
+	return false;
+#else
+	/* The newest record sits in the last slot. Keep it until the new record
+	 * has been written to slot 0 so a power loss at any point leaves at least
+	 * one valid record behind.
+	 */
+	const size_t last_slot = m_slot_count - 1U;
+	if (!erase_slots(0U, last_slot))
+	{
+		return false;
+	}
+
+	const int ret = eeprom_write(k_eeprom, slot_offset(0U), &record, sizeof(record));
+	if (ret != 0)
+	{
+		LOG_ERR("Failed to save state to EEPROM (%d)", ret);
+		return false;
+	}
+
+	m_next_slot = 1U;
+	++m_compactions;
+	LOG_DBG("Compacted EEPROM position log (%u compactions)", m_compactions);
+
+	/* A stale last slot is harmless: its sequence number is older than slot 0. */
+	(void)erase_slots(last_slot, 1U);
+	return true;
+#endif
+}
+
 uint16_t EepromPositionStore::checksum(uint16_t position) const
 {
 	return static_cast<uint16_t>(((kPositionMagic >> 16) ^ (kPositionMagic & 0xFFFFU) ^ position) & 0xFFFFU);
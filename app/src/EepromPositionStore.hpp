@@ -5,27 +5,61 @@
 
 #include "PositionStore.hpp"
 
+/* Keeps the focuser state in a log of sequence-numbered records that is
+ * appended across the whole EEPROM, so consecutive saves land on different
+ * cells. The log is only compacted (erased back to its first slot) once every
+ * slot has been used.
+ */
 class EepromPositionStore final : public PositionStore
 {
 public:
 	EepromPositionStore();
 
-	bool load(uint16_t &position_out) override;
-	void save(uint16_t position) override;
+	bool load(PersistentState &state_out) override;
+	void save(const PersistentState &state) override;
 
-private:
-	struct PositionRecord
+	/* Number of times the log wrapped and was compacted. */
+	uint32_t compactions() const
+	{
+		return m_compactions;
+	}
+
+	struct JournalRecord
+	{
+		uint32_t sequence;
+		uint8_t version;
+		uint8_t length;
+		uint8_t payload[persistent_state::kCapacity];
+		uint16_t crc;
+	};
+
+	/* Single record written at offset 0 by earlier firmware. */
+	struct LegacyRecord
 	{
 		uint32_t magic;
 		uint16_t position;
 		uint16_t checksum;
 	};
 
+	static uint16_t journal_crc(const JournalRecord &record);
+
+private:
 	bool ensure_ready();
+	bool ensure_scanned();
+	bool read_slot(size_t slot, JournalRecord &record_out) const;
+	bool find_newest(JournalRecord &newest_out, size_t &slot_out) const;
+	bool load_legacy(PersistentState &state_out) const;
+	bool erase_slots(size_t first, size_t count) const;
+	bool compact(const JournalRecord &record);
 	uint16_t checksum(uint16_t position) const;
 
 	bool m_ready{false};
+	bool m_scanned{false};
 	bool m_has_value{false};
-	uint16_t m_last_value{0U};
+	PersistentState m_last_state{};
 	size_t m_eeprom_size{0U};
+	size_t m_slot_count{0U};
+	size_t m_next_slot{0U};
+	uint32_t m_next_sequence{0U};
+	uint32_t m_compactions{0U};
 };
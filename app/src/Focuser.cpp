@@ -8,18 +8,42 @@ LOG_MODULE_DECLARE(focuser, CONFIG_APP_LOG_LEVEL);
 
 namespace
 {
+	/* Completion polling period for controllers without motion events. */
+	constexpr int32_t kMotionPollIntervalMs = 5;
+	/* Wakeup period during evented motion; only keeps the trajectory rebased. */
+	constexpr int32_t kTrajectoryRebaseIntervalMs = 1000;
+	/* Trajectories older than this are rebased, far below the 32-bit cycle wrap. */
+	constexpr uint32_t kTrajectoryRebaseCycles = 1U << 30;
+	/* Wakeup period while jogging, for the keepalive, the limits and the ramp. */
+	constexpr int32_t kJogTickMs = 10;
+
+	constexpr uint32_t kMaxSpeed = CONFIG_APP_FOCUSER_MAX_SPEED;
+	constexpr uint32_t kStartSpeed = CONFIG_APP_FOCUSER_START_SPEED;
+	constexpr uint32_t kMinSpeed = CONFIG_APP_FOCUSER_MIN_SPEED;
+	constexpr uint32_t kAcceleration = CONFIG_APP_FOCUSER_ACCELERATION;
+
 	uint32_t compute_step_period_us(uint8_t multiplier)
 	{
 		uint32_t m = (multiplier == 0U) ? 1U : static_cast<uint32_t>(multiplier);
-		uint32_t steps_per_second = 2000U / m;
-		if (steps_per_second < 100U)
+		uint32_t steps_per_second = kMaxSpeed / m;
+		if (steps_per_second < kMinSpeed)
 		{
-			steps_per_second = 100U;
+			steps_per_second = kMinSpeed;
 		}
 
 		return Z_HZ_us / steps_per_second;
 	}
 
+	MotionProfile profile_for_interval(uint64_t interval_ns)
+	{
+		const uint32_t max_speed = static_cast<uint32_t>(1000000000ULL / interval_ns);
+		return MotionProfile{
+			.max_speed = max_speed,
+			.start_speed = (kStartSpeed < max_speed) ? kStartSpeed : max_speed,
+			.acceleration = kAcceleration,
+		};
+	}
+
 } // namespace
 
 Focuser::Focuser(FocuserStepper &stepper, PositionStore *store, const char *firmware_version)
@@ -30,6 +54,18 @@ Focuser::Focuser(FocuserStepper &stepper, PositionStore *store, const char *firm
 	 */
 }
 
+void Focuser::set_notification_callback(NotificationCallback callback, void *user_data)
+{
+	m_notification_callback = callback;
+	m_notification_user_data = user_data;
+}
+
+void Focuser::set_baud_rate_callback(BaudRateCallback callback, void *user_data)
+{
+	m_baud_rate_callback = callback;
+	m_baud_rate_user_data = user_data;
+}
+
 int Focuser::initialise()
 {
 	init();
@@ -39,6 +75,12 @@ int Focuser::initialise()
 		return -ENODEV;
 	}
 
+	m_motion_events = (m_stepper.set_event_callback(&Focuser::on_stepper_event, this) == 0);
+	if (!m_motion_events)
+	{
+		LOG_WRN("Stepper cannot report motion events; polling for completion");
+	}
+
 	/* Ensure the stepper driver starts disabled; it will be enabled during motion only. */
 	int ret = set_stepper_driver_enabled(false);
 	if (ret != 0)
@@ -53,7 +95,7 @@ int Focuser::initialise()
 		return ret;
 	}
 
-	restore_position();
+	restore_state();
 
 	uint64_t interval_ns = 0;
 	{
@@ -74,60 +116,323 @@ void Focuser::init()
 {
 	k_mutex_init(&m_state.lock);
 	k_sem_init(&m_state.move_sem, 0, K_SEM_MAX_LIMIT);
+	k_poll_signal_init(&m_state.motion_signal);
+	m_motion_active = false;
+	m_notifications = false;
 	m_state.move_request = false;
 	m_state.cancel_move = false;
 	m_state.staged_position = 0U;
 	m_state.desired_position = 0U;
+	m_state.move_target = 0U;
 	m_state.speed_multiplier = 1U;
 	m_state.half_step = false;
 	m_state.temperature_coeff_times2 = 0;
+	m_state.persisted = PersistentState{};
+	m_state.moving = false;
+	m_state.fault = false;
+	m_state.program_length = 0U;
+	m_state.program_dwell_ms = 0U;
+	m_state.program_request = false;
+	m_state.program_running = false;
+	m_program_active = false;
+	m_program_dwelling = false;
+	m_state.jog_request = false;
+	m_state.jogging = false;
+	m_jog_direction = 0;
 	update_timing_locked();
+	publish_locked();
+}
+
+void Focuser::publish_locked()
+{
+	Snapshot snapshot;
+	snapshot.position = m_state.desired_position;
+	snapshot.new_position = m_state.staged_position;
+	snapshot.target = m_state.move_target;
+	snapshot.moving = m_state.moving;
+	snapshot.half_step = m_state.half_step;
+	snapshot.fault = m_state.fault;
+	snapshot.move_pending = m_state.move_request;
+	snapshot.program_running = m_state.program_running;
+	snapshot.jogging = m_state.jogging;
+	snapshot.speed = m_state.speed_multiplier;
+	snapshot.step_interval_ns = m_state.step_interval_ns;
+	snapshot.temperature_coeff_times2 = m_state.temperature_coeff_times2;
+	snapshot.trajectory = m_state.trajectory;
+	m_snapshot.store(snapshot);
+}
+
+void Focuser::publish_position(int32_t position)
+{
+	MutexLock lock(m_state.lock);
+	m_state.desired_position = static_cast<uint16_t>(position & 0xFFFF);
+	m_state.trajectory = Trajectory{};
+	publish_locked();
+}
+
+void Focuser::publish_trajectory(int32_t origin, const MotionSegment &segment,
+				 uint32_t start_cycles)
+{
+	uint64_t following_ns = m_queued_move_ns;
+	for (std::size_t i = m_plan_index; i < m_plan.size(); ++i)
+	{
+		following_ns += static_cast<uint64_t>(m_plan[i].steps) * m_plan[i].interval_ns;
+	}
+
+	MutexLock lock(m_state.lock);
+	m_state.desired_position = static_cast<uint16_t>(origin & 0xFFFF);
+	m_state.jogging = (m_jog_direction != 0);
+	m_state.trajectory = Trajectory{
+		.origin = origin,
+		.direction = m_plan_direction,
+		.steps = segment.steps,
+		.interval_ns = segment.interval_ns,
+		.start_cycles = start_cycles,
+		.following_ns = following_ns,
+	};
+	publish_locked();
+}
+
+void Focuser::rebase_trajectory()
+{
+	MutexLock lock(m_state.lock);
+	Trajectory &trajectory = m_state.trajectory;
+	const uint32_t elapsed = k_cycle_get_32() - trajectory.start_cycles;
+	if ((trajectory.direction == 0) || (elapsed < kTrajectoryRebaseCycles))
+	{
+		return;
+	}
+
+	/* Advance by whole steps so no fraction of a step is lost. */
+	uint64_t done = k_cyc_to_ns_floor64(elapsed) / trajectory.interval_ns;
+	done = (done < trajectory.steps) ? done : trajectory.steps;
+	trajectory.origin += trajectory.direction * static_cast<int32_t>(done);
+	trajectory.steps -= static_cast<uint32_t>(done);
+	trajectory.start_cycles += k_ns_to_cyc_floor32(done * trajectory.interval_ns);
+	m_state.desired_position = static_cast<uint16_t>(trajectory.origin & 0xFFFF);
+	publish_locked();
+}
+
+uint16_t Focuser::Snapshot::position_at(uint32_t now_cycles) const
+{
+	if ((trajectory.direction == 0) || (trajectory.interval_ns == 0U))
+	{
+		return position;
+	}
+
+	const uint64_t elapsed_ns = k_cyc_to_ns_floor64(now_cycles - trajectory.start_cycles);
+	const uint64_t done = elapsed_ns / trajectory.interval_ns;
+	const int32_t steps = static_cast<int32_t>((done < trajectory.steps) ? done : trajectory.steps);
+	return static_cast<uint16_t>((trajectory.origin + trajectory.direction * steps) & 0xFFFF);
+}
+
+uint64_t Focuser::Snapshot::remaining_ns_at(uint32_t now_cycles) const
+{
+	if (jogging)
+	{
+		/* Open-ended until the client stops sending XJ. */
+		return 0U;
+	}
+
+	if (trajectory.direction != 0)
+	{
+		const uint64_t elapsed_ns = k_cyc_to_ns_floor64(now_cycles - trajectory.start_cycles);
+		const uint64_t segment_ns = static_cast<uint64_t>(trajectory.steps) * trajectory.interval_ns;
+		return ((segment_ns > elapsed_ns) ? (segment_ns - elapsed_ns) : 0U) + trajectory.following_ns;
+	}
+
+	if (!move_pending || (step_interval_ns == 0U))
+	{
+		return 0U;
+	}
+
+	/* Not started yet: plan it the way start_motion() will. */
+	const uint32_t distance = (target > position) ? (target - position) : (position - target);
+	return plan_move(distance, profile_for_interval(step_interval_ns)).duration_us() * 1000U;
 }
 
 void Focuser::loop()
 {
 	while (true)
 	{
-		k_sem_take(&m_state.move_sem, K_FOREVER);
+		(void)run_once(K_FOREVER);
+	}
+}
 
-		while (true)
+int Focuser::run_once(k_timeout_t timeout)
+{
+	if (m_motion_active && K_TIMEOUT_EQ(timeout, K_FOREVER))
+	{
+		timeout = K_MSEC(m_motion_events ? kTrajectoryRebaseIntervalMs : kMotionPollIntervalMs);
+	}
+	if ((m_jog_direction != 0) && !K_TIMEOUT_EQ(timeout, K_NO_WAIT))
+	{
+		timeout = K_MSEC(kJogTickMs);
+	}
+	if (m_program_dwelling && !K_TIMEOUT_EQ(timeout, K_NO_WAIT))
+	{
+		/* Wake when the dwell at the current point is over. */
+		const int64_t left = m_point_arrival_ms + m_program[m_program_index].dwell_ms -
+				     k_uptime_get();
+		timeout = K_MSEC((left > 0) ? left : 0);
+	}
+
+	struct k_poll_event events[2];
+	k_poll_event_init(&events[0], K_POLL_TYPE_SEM_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY,
+			  &m_state.move_sem);
+	k_poll_event_init(&events[1], K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY,
+			  &m_state.motion_signal);
+
+	const int ret = k_poll(events, ARRAY_SIZE(events), timeout);
+	bool processed = (ret == 0);
+
+	if (events[0].state == K_POLL_STATE_SEM_AVAILABLE)
+	{
+		(void)k_sem_take(&m_state.move_sem, K_NO_WAIT);
+	}
+
+	bool check_motion = !m_motion_events;
+	if (events[1].state == K_POLL_STATE_SIGNALED)
+	{
+		/* Reset before querying the controller so a completion racing with
+		 * this check is either seen as idle now or re-signals the next poll.
+		 */
+		k_poll_signal_reset(&m_state.motion_signal);
+		check_motion = true;
+	}
+
+	/* Events from an earlier, cancelled move may arrive after a new one has
+	 * started, so completion is only taken from the controller itself.
+	 */
+	if (m_motion_active && check_motion && stepper_idle())
+	{
+		if ((m_plan_index >= m_plan.size()) || !start_next_segment())
 		{
-			bool should_cancel = false;
-			bool have_move = false;
-			uint16_t target = 0U;
+			finish_motion(MoveEnd::completed);
+		}
+		processed = true;
+	}
 
-			{
-				MutexLock lock(m_state.lock);
-				if (m_state.cancel_move)
-				{
-					should_cancel = true;
-					m_state.cancel_move = false;
-				}
-				else if (m_state.move_request)
-				{
-					target = m_state.desired_position;
-					m_state.move_request = false;
-					have_move = true;
-					LOG_DBG("Starting motion toward 0x%04x (%u)", target, target);
-				}
-			}
+	process_requests();
+	if (m_jog_direction != 0)
+	{
+		update_jog();
+	}
+	if (m_motion_active)
+	{
+		rebase_trajectory();
+	}
+	if (m_program_dwelling &&
+	    ((k_uptime_get() - m_point_arrival_ms) >= m_program[m_program_index].dwell_ms))
+	{
+		advance_program();
+		processed = true;
+	}
+	return processed ? 0 : -EAGAIN;
+}
 
-			if (should_cancel)
-			{
-				(void)m_stepper.stop();
-				const uint16_t actual16 = static_cast<uint16_t>(read_actual_position() & 0xFFFF);
-				MutexLock lock(m_state.lock);
-				m_state.desired_position = actual16;
-				break;
-			}
+void Focuser::on_stepper_event(FocuserStepper::Event event, void *user_data)
+{
+	auto *self = static_cast<Focuser *>(user_data);
+	k_poll_signal_raise(&self->m_state.motion_signal, static_cast<int>(event));
+}
+
+void Focuser::process_requests()
+{
+	bool should_cancel = false;
+	bool have_move = false;
+	bool have_program = false;
+	bool have_jog = false;
+	uint16_t target = 0U;
+	int16_t jog_rate = 0;
+	int64_t jog_deadline_ms = 0;
 
-			if (!have_move)
+	{
+		MutexLock lock(m_state.lock);
+		if (m_state.cancel_move)
+		{
+			should_cancel = true;
+			m_state.cancel_move = false;
+		}
+		else if (m_state.move_request && !m_reversing)
+		{
+			target = m_state.move_target;
+			m_state.move_request = false;
+			have_move = true;
+			LOG_DBG("Starting motion toward 0x%04x (%u)", target, target);
+		}
+		else if (m_state.jog_request && !m_reversing)
+		{
+			jog_rate = m_state.jog_rate;
+			jog_deadline_ms = m_state.jog_deadline_ms;
+			have_jog = true;
+			/* A jog that needs the motor stopped first stays pending until it is. */
+			const int32_t direction = (jog_rate > 0) ? 1 : ((jog_rate < 0) ? -1 : 0);
+			m_state.jog_request = (direction != 0) && (direction != m_jog_direction) &&
+					      m_motion_active && (jog_deadline_ms > k_uptime_get());
+		}
+		else if (m_state.program_request && !m_motion_active)
+		{
+			/* Later uploads build the next program, not this one. */
+			m_program = m_state.program;
+			m_program_length = m_state.program_length;
+			m_state.program_request = false;
+			have_program = true;
+		}
+	}
+
+	if (should_cancel)
+	{
+		(void)m_stepper.stop();
+		if (m_motion_active)
+		{
+			LOG_DBG("Stopping active motion per cancel request");
+			finish_motion(MoveEnd::cancelled);
+		}
+		else
+		{
+			const int32_t actual = read_actual_position();
+			publish_position(actual);
+			if (m_program_active)
 			{
-				break;
+				/* Stopped while dwelling at a point. */
+				report_move_end(moonlite::Notification::move_cancelled,
+						static_cast<uint16_t>(actual & 0xFFFF));
 			}
-
-			move_to(target);
 		}
+		return;
+	}
+
+	if (have_program)
+	{
+		start_program();
+		return;
+	}
+
+	if (have_jog)
+	{
+		handle_jog(jog_rate, jog_deadline_ms);
+		return;
+	}
+
+	if (!have_move)
+	{
+		return;
+	}
+
+	if (m_program_active)
+	{
+		LOG_INF("Move request ends the motion program");
+		end_program();
+	}
+
+	if (m_motion_active)
+	{
+		retarget(target);
+	}
+	else
+	{
+		start_motion(target);
 	}
 }
 
@@ -139,7 +444,11 @@ void Focuser::stop()
 		MutexLock lock(m_state.lock);
 		m_state.cancel_move = true;
 		m_state.move_request = false;
+		m_state.program_request = false;
+		m_state.jog_request = false;
 		m_state.desired_position = actual16;
+		m_state.trajectory = Trajectory{};
+		publish_locked();
 	}
 	(void)m_stepper.stop();
 	(void)set_stepper_driver_enabled(false);
@@ -151,12 +460,8 @@ void Focuser::stop()
 uint16_t Focuser::getCurrentPosition()
 {
 	LOG_DBG("getCurrentPosition()");
-	const int32_t actual = read_actual_position();
-	const uint16_t pos = static_cast<uint16_t>(actual & 0xFFFF);
-	{
-		MutexLock lock(m_state.lock);
-		m_state.desired_position = pos;
-	}
+	/* Extrapolated from the published trajectory; never queries the driver. */
+	const uint16_t pos = m_snapshot.load().position_at(k_cycle_get_32());
 	LOG_DBG("getCurrentPosition -> 0x%04x (%u)", pos, pos);
 	return pos;
 }
@@ -169,9 +474,9 @@ void Focuser::setCurrentPosition(uint16_t position)
 uint16_t Focuser::getNewPosition()
 {
 	LOG_DBG("getNewPosition()");
-	MutexLock lock(m_state.lock);
-	LOG_DBG("getNewPosition -> 0x%04x (%u)", m_state.staged_position, m_state.staged_position);
-	return m_state.staged_position;
+	const uint16_t position = m_snapshot.load().new_position;
+	LOG_DBG("getNewPosition -> 0x%04x (%u)", position, position);
+	return position;
 }
 
 void Focuser::setNewPosition(uint16_t position)
@@ -180,6 +485,7 @@ void Focuser::setNewPosition(uint16_t position)
 	MutexLock lock(m_state.lock);
 	LOG_INF("setNewPosition 0x%04x (%u) (was 0x%04x)", position, position, m_state.staged_position);
 	m_state.staged_position = position;
+	publish_locked();
 }
 
 void Focuser::goToNewPosition()
@@ -188,21 +494,65 @@ void Focuser::goToNewPosition()
 	uint16_t target;
 	{
 		MutexLock lock(m_state.lock);
-		m_state.desired_position = m_state.staged_position;
-		m_state.move_request = true;
-		m_state.cancel_move = false;
 		target = m_state.staged_position;
+		request_move_locked(target);
 	}
 	k_sem_give(&m_state.move_sem);
 	LOG_INF("goToNewPosition target=0x%04x (%u)", target, target);
 }
 
+void Focuser::goToPosition(uint16_t position)
+{
+	LOG_DBG("goToPosition()");
+	{
+		MutexLock lock(m_state.lock);
+		m_state.staged_position = position;
+		request_move_locked(position);
+	}
+	k_sem_give(&m_state.move_sem);
+	LOG_INF("goToPosition target=0x%04x (%u)", position, position);
+}
+
+void Focuser::moveRelative(int16_t delta)
+{
+	LOG_DBG("moveRelative()");
+	uint16_t target;
+	{
+		MutexLock lock(m_state.lock);
+		/* Count from where the focuser is heading, so repeated nudges add
+		 * up. A jog heads nowhere in particular: count from where it is.
+		 */
+		uint16_t base = m_state.desired_position;
+		if (m_state.move_request || (m_state.moving && !m_state.jogging))
+		{
+			base = m_state.move_target;
+		}
+		else if (m_state.jogging)
+		{
+			base = position_at_locked(k_cycle_get_32());
+		}
+		target = moonlite::clampedPosition(base, delta);
+		m_state.staged_position = target;
+		request_move_locked(target);
+	}
+	k_sem_give(&m_state.move_sem);
+	LOG_INF("moveRelative %d target=0x%04x (%u)", delta, target, target);
+}
+
+void Focuser::request_move_locked(uint16_t target)
+{
+	m_state.move_target = target;
+	m_state.move_request = true;
+	m_state.cancel_move = false;
+	publish_locked();
+}
+
 bool Focuser::isHalfStep()
 {
 	LOG_DBG("isHalfStep()");
-	MutexLock lock(m_state.lock);
-	LOG_DBG("isHalfStep -> %s", m_state.half_step ? "true" : "false");
-	return m_state.half_step;
+	const bool half_step = m_snapshot.load().half_step;
+	LOG_DBG("isHalfStep -> %s", half_step ? "true" : "false");
+	return half_step;
 }
 
 void Focuser::setHalfStep(bool enabled)
@@ -212,35 +562,33 @@ void Focuser::setHalfStep(bool enabled)
 	LOG_INF("setHalfStep %s (was %s)", enabled ? "true" : "false",
 		m_state.half_step ? "true" : "false");
 	m_state.half_step = enabled;
+	publish_locked();
+	m_state.persisted.half_step = enabled;
+	persist_locked();
 }
 
 bool Focuser::isMoving()
 {
 	LOG_DBG("isMoving()");
-	bool moving = false;
-	int ret = m_stepper.is_moving(moving);
-	if (ret != 0)
-	{
-		LOG_WRN("stepper_is_moving failed (%d)", ret);
-		return false;
-	}
+	/* Covers the whole planned move, including the gaps between segments. */
+	const bool moving = m_snapshot.load().moving;
 	LOG_DBG("isMoving -> %s", moving ? "true" : "false");
 	return moving;
 }
 
-std::string Focuser::getFirmwareVersion()
+std::string_view Focuser::getFirmwareVersion()
 {
 	LOG_DBG("getFirmwareVersion()");
 	LOG_DBG("getFirmwareVersion -> %s", m_firmware_version);
-	return std::string(m_firmware_version);
+	return std::string_view(m_firmware_version);
 }
 
 uint8_t Focuser::getSpeed()
 {
 	LOG_DBG("getSpeed()");
-	MutexLock lock(m_state.lock);
-	LOG_DBG("getSpeed -> 0x%02x (%u)", m_state.speed_multiplier, m_state.speed_multiplier);
-	return m_state.speed_multiplier;
+	const uint8_t speed = m_snapshot.load().speed;
+	LOG_DBG("getSpeed -> 0x%02x (%u)", speed, speed);
+	return speed;
 }
 
 void Focuser::setSpeed(uint8_t speed)
@@ -250,15 +598,17 @@ void Focuser::setSpeed(uint8_t speed)
 	{
 		speed = 1U;
 	}
-	uint64_t interval_ns = 0;
-	{
-		MutexLock lock(m_state.lock);
-		LOG_INF("setSpeed 0x%02x (%u) (was 0x%02x)", speed, speed, m_state.speed_multiplier);
-		m_state.speed_multiplier = speed;
-		update_timing_locked();
-		interval_ns = m_state.step_interval_ns;
-	}
-	(void)apply_step_interval(interval_ns);
+	/* Only the cruise speed of later moves changes. Each segment and jog
+	 * applies its own interval on the focuser thread, so the controller is
+	 * never touched from here, where it could race with a starting move.
+	 */
+	MutexLock lock(m_state.lock);
+	LOG_INF("setSpeed 0x%02x (%u) (was 0x%02x)", speed, speed, m_state.speed_multiplier);
+	m_state.speed_multiplier = speed;
+	update_timing_locked();
+	publish_locked();
+	m_state.persisted.speed_multiplier = speed;
+	persist_locked();
 }
 
 uint16_t Focuser::getTemperature()
@@ -271,93 +621,701 @@ uint16_t Focuser::getTemperature()
 uint8_t Focuser::getTemperatureCoefficientRaw()
 {
 	LOG_DBG("getTemperatureCoefficientRaw()");
-	MutexLock lock(m_state.lock);
+	const int8_t coeff_times2 = m_snapshot.load().temperature_coeff_times2;
 	LOG_DBG("getTemperatureCoefficientRaw -> 0x%02x (%d -> %.1f)",
-		static_cast<uint8_t>(m_state.temperature_coeff_times2),
-		static_cast<int>(m_state.temperature_coeff_times2),
-		static_cast<double>(m_state.temperature_coeff_times2) / 2.0);
-	return static_cast<uint8_t>(m_state.temperature_coeff_times2);
+		static_cast<uint8_t>(coeff_times2), static_cast<int>(coeff_times2),
+		static_cast<double>(coeff_times2) / 2.0);
+	return static_cast<uint8_t>(coeff_times2);
 }
 
-void Focuser::move_to(uint16_t target)
+void Focuser::setNotifications(bool enabled)
+{
+	LOG_INF("setNotifications %s", enabled ? "true" : "false");
+	m_notifications = enabled;
+}
+
+bool Focuser::setBaudRate(uint32_t baud)
+{
+	LOG_DBG("setBaudRate(%u)", baud);
+	const bool accepted = (m_baud_rate_callback != nullptr) &&
+			      m_baud_rate_callback(baud, m_baud_rate_user_data);
+	LOG_INF("setBaudRate %u %s", baud, accepted ? "accepted" : "refused");
+	return accepted;
+}
+
+moonlite::Status Focuser::getStatus()
+{
+	LOG_DBG("getStatus()");
+	/* One snapshot, so the fields cannot straddle a state change. */
+	const Snapshot snapshot = m_snapshot.load();
+	moonlite::Status status{snapshot.position_at(k_cycle_get_32()), snapshot.new_position, 0x0000,
+				0U};
+	status.flags = static_cast<uint8_t>((snapshot.moving ? moonlite::kStatusMoving : 0U) |
+					    (snapshot.half_step ? moonlite::kStatusHalfStep : 0U) |
+					    (snapshot.program_running ? moonlite::kStatusProgram : 0U) |
+					    (snapshot.fault ? moonlite::kStatusFault : 0U));
+	LOG_DBG("getStatus -> 0x%04x 0x%04x 0x%02x", status.position, status.target, status.flags);
+	return status;
+}
+
+uint32_t Focuser::getRemainingMoveTime()
+{
+	LOG_DBG("getRemainingMoveTime()");
+	/* Rounded up, so a client sleeping this long wakes after the move. */
+	const uint64_t remaining_ns = m_snapshot.load().remaining_ns_at(k_cycle_get_32());
+	const uint64_t remaining_ms = (remaining_ns + 999999U) / 1000000U;
+	const uint32_t ms = (remaining_ms < UINT32_MAX) ? static_cast<uint32_t>(remaining_ms) : UINT32_MAX;
+	LOG_DBG("getRemainingMoveTime -> %u ms", ms);
+	return ms;
+}
+
+void Focuser::clearProgram()
+{
+	LOG_DBG("clearProgram()");
+	MutexLock lock(m_state.lock);
+	m_state.program_length = 0U;
+	m_state.program_dwell_ms = 0U;
+}
+
+void Focuser::setProgramDwell(uint16_t dwell_ms)
+{
+	LOG_DBG("setProgramDwell(%u)", dwell_ms);
+	MutexLock lock(m_state.lock);
+	m_state.program_dwell_ms = dwell_ms;
+}
+
+void Focuser::addProgramPoint(uint16_t position)
+{
+	LOG_DBG("addProgramPoint(0x%04x)", position);
+	MutexLock lock(m_state.lock);
+	if (m_state.program_length >= kMaxProgramPoints)
+	{
+		LOG_WRN("Motion program full; point 0x%04x dropped", position);
+		return;
+	}
+	m_state.program[m_state.program_length] = ProgramPoint{position, m_state.program_dwell_ms};
+	++m_state.program_length;
+}
+
+void Focuser::runProgram()
+{
+	LOG_DBG("runProgram()");
+	{
+		MutexLock lock(m_state.lock);
+		m_state.program_request = true;
+	}
+	k_sem_give(&m_state.move_sem);
+	LOG_INF("runProgram");
+}
+
+void Focuser::jog(int16_t rate)
+{
+	LOG_DBG("jog(%d)", rate);
+	{
+		MutexLock lock(m_state.lock);
+		m_state.jog_rate = rate;
+		m_state.jog_deadline_ms = k_uptime_get() + CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS;
+		m_state.jog_request = true;
+	}
+	k_sem_give(&m_state.move_sem);
+}
+
+uint32_t Focuser::getProgramPointTime(uint8_t index)
+{
+	return program_point_stats(index).move_ms;
+}
+
+Focuser::ProgramPointStats Focuser::program_point_stats(std::size_t index)
+{
+	MutexLock lock(m_state.lock);
+	return (index < kMaxProgramPoints) ? m_state.program_stats[index] : ProgramPointStats{};
+}
+
+MotionProfile Focuser::motion_profile()
 {
 	uint64_t interval_ns = 0;
 	{
 		MutexLock lock(m_state.lock);
 		interval_ns = m_state.step_interval_ns;
 	}
+	return profile_for_interval(interval_ns);
+}
+
+uint32_t Focuser::current_speed() const
+{
+	if (m_jog_direction != 0)
+	{
+		return m_jog_speed;
+	}
+	if ((m_plan_index == 0U) || (m_plan_index > m_plan.size()))
+	{
+		return 0U;
+	}
+	return static_cast<uint32_t>(1000000000ULL / m_plan[m_plan_index - 1U].interval_ns);
+}
+
+void Focuser::load_plan(int32_t origin, uint16_t target, const MotionProfile &profile,
+			uint32_t initial_speed)
+{
+	const int32_t distance = static_cast<int32_t>(target) - origin;
+	m_plan = plan_move(static_cast<uint32_t>((distance < 0) ? -distance : distance), profile,
+			   initial_speed);
+	m_plan_index = 0U;
+	m_plan_position = origin;
+	m_plan_direction = (distance < 0) ? -1 : 1;
+	m_queued_move_ns = 0U;
+
+	LOG_DBG("Planned %u step(s) in %u segment(s), %u us",
+		static_cast<unsigned int>(m_plan.total_steps()),
+		static_cast<unsigned int>(m_plan.size()),
+		static_cast<unsigned int>(m_plan.duration_us()));
+}
+
+void Focuser::start_motion(uint16_t target)
+{
+	load_plan(read_actual_position(), target, motion_profile(), 0U);
+	if (m_plan.empty())
+	{
+		LOG_DBG("Already at 0x%04x (%u)", target, target);
+		report_move_end(moonlite::Notification::move_completed, target);
+		return;
+	}
 
 	const bool enabled_for_move = (set_stepper_driver_enabled(true) == 0);
 	if (!enabled_for_move)
 	{
+		set_fault();
+		report_move_end(moonlite::Notification::move_failed,
+				static_cast<uint16_t>(read_actual_position() & 0xFFFF));
 		return;
 	}
 
-	if (apply_step_interval(interval_ns) != 0)
+	if (!start_next_segment())
 	{
 		(void)set_stepper_driver_enabled(false);
+		report_move_end(moonlite::Notification::move_failed,
+				static_cast<uint16_t>(read_actual_position() & 0xFFFF));
 		return;
 	}
 
-	int ret = m_stepper.move_to(static_cast<int32_t>(target));
-	if (ret != 0)
+	m_motion_active = true;
+	if (m_store != nullptr)
 	{
-		LOG_ERR("Failed to start move to 0x%04x (%d)", target, ret);
-		(void)set_stepper_driver_enabled(false);
-		return;
+		m_store->set_motion_active(true);
 	}
 
-	while (true)
+	MutexLock lock(m_state.lock);
+	m_state.moving = true;
+	m_state.fault = false;
+	publish_locked();
+}
+
+void Focuser::retarget(uint16_t target)
+{
+	const MotionProfile profile = motion_profile();
+	const uint32_t speed = current_speed();
+	const int32_t position = read_actual_position();
+	const int32_t distance = static_cast<int32_t>(target) - position;
+	const uint32_t remaining = static_cast<uint32_t>((distance < 0) ? -distance : distance);
+	const bool same_direction = (distance != 0) && ((distance < 0) == (m_plan_direction < 0));
+
+	if (same_direction && (remaining >= stopping_distance(speed, profile)))
 	{
-		bool moving = false;
-		ret = m_stepper.is_moving(moving);
-		if (ret != 0)
-		{
-			LOG_ERR("stepper_is_moving failed (%d)", ret);
-			break;
-		}
-		if (!moving)
+		/* Replace the rest of the plan; the controller takes the new
+		 * waypoint on the fly, so the motor never stops.
+		 */
+		LOG_DBG("Retargeting to 0x%04x (%u) at %u steps/s", target, target, speed);
+		load_plan(position, target, profile, speed);
+		if (!start_next_segment())
 		{
-			break;
+			(void)m_stepper.stop();
+			finish_motion(MoveEnd::completed);
 		}
+		return;
+	}
 
-		bool should_cancel = false;
+	/* Reversing, or too close to stop in time: decelerate first and let the
+	 * request start a fresh move from rest once the motor has stopped.
+	 */
+	LOG_DBG("Decelerating from %u steps/s before moving to 0x%04x (%u)", speed, target, target);
+	m_plan = plan_stop(speed, profile);
+	m_plan_index = 0U;
+	m_plan_position = position;
+	/* The pending move restarts from rest where the ramp ends. */
+	const int32_t stop_position =
+		position + m_plan_direction * static_cast<int32_t>(m_plan.total_steps());
+	const int32_t queued = static_cast<int32_t>(target) - stop_position;
+	const uint32_t queued_steps = static_cast<uint32_t>((queued < 0) ? -queued : queued);
+	m_queued_move_ns = plan_move(queued_steps, profile).duration_us() * 1000U;
+	if (!m_plan.empty() && start_next_segment())
+	{
+		MutexLock lock(m_state.lock);
+		if (!m_state.move_request)
 		{
-			MutexLock lock(m_state.lock);
-			should_cancel = m_state.cancel_move;
-			if (should_cancel)
-			{
-				m_state.cancel_move = false;
-			}
+			m_state.move_request = true;
+			m_state.move_target = target;
+			publish_locked();
 		}
+		m_reversing = true;
+		return;
+	}
 
-		if (should_cancel)
-		{
-			LOG_DBG("Stopping active motion per cancel request");
-			(void)m_stepper.stop();
-			break;
-		}
+	/* Slow enough to stop on the spot. */
+	(void)m_stepper.stop();
+	finish_motion(MoveEnd::superseded);
+	start_motion(target);
+}
+
+bool Focuser::start_next_segment()
+{
+	const MotionSegment &segment = m_plan[m_plan_index];
+	const int32_t origin = m_plan_position;
+	++m_plan_index;
+	m_plan_position += m_plan_direction * static_cast<int32_t>(segment.steps);
 
-		k_msleep(5);
+	if (apply_step_interval(segment.interval_ns) != 0)
+	{
+		set_fault();
+		return false;
+	}
+
+	const int ret = m_stepper.move_to(m_plan_position);
+	if (ret != 0)
+	{
+		LOG_ERR("Failed to start move to %d (%d)", m_plan_position, ret);
+		set_fault();
+		return false;
 	}
 
+	/* GP extrapolates from here until the next segment boundary. */
+	publish_trajectory(origin, segment, k_cycle_get_32());
+	return true;
+}
+
+void Focuser::set_fault()
+{
+	MutexLock lock(m_state.lock);
+	m_state.fault = true;
+	publish_locked();
+}
+
+void Focuser::finish_motion(MoveEnd end)
+{
+	m_motion_active = false;
+	m_reversing = false;
+	m_jog_direction = 0;
+	m_plan_index = m_plan.size();
+	m_queued_move_ns = 0U;
+
 	const int32_t actual = read_actual_position();
 	bool pending_move = false;
+	bool failed = false;
 	const uint16_t actual16 = static_cast<uint16_t>(actual & 0xFFFF);
 	{
 		MutexLock lock(m_state.lock);
 		m_state.desired_position = actual16;
-		pending_move = m_state.move_request;
+		m_state.trajectory = Trajectory{};
+		m_state.moving = false;
+		m_state.jogging = false;
+		pending_move = m_state.move_request || m_state.jog_request;
+		failed = m_state.fault;
+		publish_locked();
 	}
+
+	save_position(actual16);
 	if (!pending_move)
 	{
 		(void)set_stepper_driver_enabled(false);
+		if (m_store != nullptr)
+		{
+			m_store->set_motion_active(false);
+		}
+	}
+
+	/* A queued request (e.g. the far side of a reversal) continues the move. */
+	if (!pending_move && (end != MoveEnd::superseded))
+	{
+		if (failed)
+		{
+			report_move_end(moonlite::Notification::move_failed, actual16);
+		}
+		else
+		{
+			report_move_end((end == MoveEnd::cancelled)
+						? moonlite::Notification::move_cancelled
+						: moonlite::Notification::move_completed,
+					actual16);
+		}
 	}
 
-	save_position(actual16);
 	LOG_DBG("Motion complete -> 0x%04x (%d)", static_cast<uint16_t>(actual & 0xFFFF), actual);
 }
 
+void Focuser::notify(moonlite::Notification notification, uint16_t position)
+{
+	if (!m_notifications || (m_notification_callback == nullptr))
+	{
+		return;
+	}
+	LOG_DBG("Notification %c at 0x%04x (%u)", static_cast<char>(notification), position, position);
+	m_notification_callback(notification, position, m_notification_user_data);
+}
+
+void Focuser::report_move_end(moonlite::Notification notification, uint16_t position)
+{
+	if (!m_program_active)
+	{
+		notify(notification, position);
+		return;
+	}
+
+	if (notification == moonlite::Notification::move_completed)
+	{
+		program_point_reached(position);
+		return;
+	}
+
+	LOG_WRN("Motion program ended at point %u", static_cast<unsigned int>(m_program_index));
+	end_program();
+	notify(notification, position);
+}
+
+void Focuser::start_program()
+{
+	if (m_program_active)
+	{
+		/* Accepted while dwelling; the old dwell must not advance the new program. */
+		LOG_INF("New motion program replaces the running one");
+		end_program();
+	}
+
+	LOG_INF("Running motion program of %u point(s)", static_cast<unsigned int>(m_program_length));
+	uint16_t position = 0U;
+	{
+		MutexLock lock(m_state.lock);
+		m_state.program_stats.fill(ProgramPointStats{});
+		m_state.program_running = (m_program_length > 0U);
+		position = m_state.desired_position;
+		publish_locked();
+	}
+
+	if (m_program_length == 0U)
+	{
+		notify(moonlite::Notification::move_completed, position);
+		return;
+	}
+
+	m_program_active = true;
+	m_program_index = 0U;
+	start_program_point();
+}
+
+void Focuser::start_program_point()
+{
+	const uint16_t target = m_program[m_program_index].target;
+	const MotionProfile profile = motion_profile();
+	m_point_start_ms = k_uptime_get();
+	{
+		MutexLock lock(m_state.lock);
+		const uint16_t position = m_state.desired_position;
+		const uint32_t distance = (target > position) ? (target - position) : (position - target);
+		const uint64_t planned_us = plan_move(distance, profile).duration_us();
+		m_state.program_stats[m_program_index].planned_ms =
+			static_cast<uint32_t>((planned_us + 999U) / 1000U);
+		m_state.move_target = target;
+		publish_locked();
+	}
+
+	LOG_DBG("Program point %u -> 0x%04x (%u)", static_cast<unsigned int>(m_program_index), target,
+		target);
+	start_motion(target);
+}
+
+void Focuser::program_point_reached(uint16_t position)
+{
+	m_point_arrival_ms = k_uptime_get();
+	m_program_dwelling = true;
+	{
+		MutexLock lock(m_state.lock);
+		m_state.program_stats[m_program_index].move_ms =
+			static_cast<uint32_t>(m_point_arrival_ms - m_point_start_ms);
+	}
+	notify(moonlite::Notification::point_reached, position);
+}
+
+void Focuser::advance_program()
+{
+	m_program_dwelling = false;
+	/* At rest while dwelling, so this is also where the program ends. */
+	uint16_t position = 0U;
+	{
+		MutexLock lock(m_state.lock);
+		m_state.program_stats[m_program_index].dwell_ms =
+			static_cast<uint32_t>(k_uptime_get() - m_point_arrival_ms);
+		position = m_state.desired_position;
+	}
+
+	++m_program_index;
+	if (m_program_index < m_program_length)
+	{
+		start_program_point();
+		return;
+	}
+
+	for (std::size_t i = 0; i < m_program_length; ++i)
+	{
+		const ProgramPointStats stats = program_point_stats(i);
+		LOG_DBG("Program point %u: planned %u ms, moved %u ms, dwelled %u ms",
+			static_cast<unsigned int>(i), stats.planned_ms, stats.move_ms, stats.dwell_ms);
+	}
+	LOG_INF("Motion program complete");
+	end_program();
+	notify(moonlite::Notification::move_completed, position);
+}
+
+void Focuser::end_program()
+{
+	m_program_active = false;
+	m_program_dwelling = false;
+
+	MutexLock lock(m_state.lock);
+	m_state.program_running = false;
+	publish_locked();
+}
+
+void Focuser::handle_jog(int16_t rate, int64_t deadline_ms)
+{
+	const int32_t direction = (rate > 0) ? 1 : ((rate < 0) ? -1 : 0);
+	if (deadline_ms <= k_uptime_get())
+	{
+		/* Queued behind a stop for longer than the keepalive. */
+		LOG_DBG("Dropping expired jog request (%d)", rate);
+		return;
+	}
+
+	if ((direction != 0) && m_program_active)
+	{
+		LOG_INF("Jog ends the motion program");
+		end_program();
+	}
+
+	if (direction == 0)
+	{
+		if (m_jog_direction != 0)
+		{
+			LOG_INF("Jog released");
+			decelerate_to_rest();
+		}
+		return;
+	}
+
+	const uint32_t speed = static_cast<uint32_t>((rate < 0) ? -static_cast<int32_t>(rate) : rate);
+	const uint32_t max_speed = motion_profile().max_speed;
+	if (direction == m_jog_direction)
+	{
+		/* Keepalive; update_jog() ramps to a changed rate. */
+		m_jog_deadline_ms = deadline_ms;
+		m_jog_target_speed = (speed < max_speed) ? speed : max_speed;
+		return;
+	}
+
+	if (m_motion_active)
+	{
+		/* Reversing a jog or interrupting a planned move. */
+		LOG_DBG("Decelerating before jogging at %d steps/s", rate);
+		decelerate_to_rest();
+		return;
+	}
+
+	m_jog_deadline_ms = deadline_ms;
+	m_jog_target_speed = (speed < max_speed) ? speed : max_speed;
+	start_jog(direction, m_jog_target_speed);
+}
+
+void Focuser::start_jog(int32_t direction, uint32_t speed)
+{
+	const int32_t position = read_actual_position();
+	const int32_t limit = (direction > 0) ? 0xFFFF : 0;
+	if (position == limit)
+	{
+		LOG_DBG("Already at the end of travel (%d)", position);
+		return;
+	}
+
+	if (set_stepper_driver_enabled(true) != 0)
+	{
+		set_fault();
+		report_move_end(moonlite::Notification::move_failed,
+				static_cast<uint16_t>(position & 0xFFFF));
+		return;
+	}
+
+	/* Start at up to the start speed; update_jog() ramps from there. */
+	const uint32_t start_speed = motion_profile().start_speed;
+	m_jog_speed = (speed < start_speed) ? speed : start_speed;
+	const MotionSegment segment{
+		.steps = static_cast<uint32_t>((limit > position) ? (limit - position) : (position - limit)),
+		.interval_ns = 1000000000ULL / m_jog_speed,
+	};
+	int ret = apply_step_interval(segment.interval_ns);
+	if (ret == 0)
+	{
+		ret = m_stepper.run((direction > 0) ? FocuserStepper::Direction::positive
+						     : FocuserStepper::Direction::negative);
+		if (ret != 0)
+		{
+			LOG_ERR("Failed to start jog (%d)", ret);
+		}
+	}
+	if (ret != 0)
+	{
+		set_fault();
+		(void)set_stepper_driver_enabled(false);
+		report_move_end(moonlite::Notification::move_failed,
+				static_cast<uint16_t>(position & 0xFFFF));
+		return;
+	}
+
+	LOG_INF("Jogging %s at %u steps/s", (direction > 0) ? "out" : "in", m_jog_target_speed);
+	m_plan = MotionPlan{};
+	m_plan_index = 0U;
+	m_plan_position = position;
+	m_plan_direction = direction;
+	m_queued_move_ns = 0U;
+	m_jog_direction = direction;
+	m_jog_ramp_ms = k_uptime_get();
+	m_motion_active = true;
+	if (m_store != nullptr)
+	{
+		m_store->set_motion_active(true);
+	}
+
+	{
+		MutexLock lock(m_state.lock);
+		m_state.moving = true;
+		m_state.fault = false;
+	}
+	publish_trajectory(position, segment, k_cycle_get_32());
+}
+
+void Focuser::update_jog()
+{
+	const int64_t now_ms = k_uptime_get();
+	if (now_ms >= m_jog_deadline_ms)
+	{
+		LOG_INF("Jog keepalive expired");
+		decelerate_to_rest();
+		return;
+	}
+
+	/* Whole steps along the current trajectory; the fraction of the step
+	 * in progress stays in start_cycles so speed changes lose no time.
+	 * Copied from m_state: see m_snapshot for why this thread never loads it.
+	 */
+	Trajectory trajectory;
+	{
+		MutexLock lock(m_state.lock);
+		trajectory = m_state.trajectory;
+	}
+	uint64_t done = k_cyc_to_ns_floor64(k_cycle_get_32() - trajectory.start_cycles) /
+			trajectory.interval_ns;
+	done = (done < trajectory.steps) ? done : trajectory.steps;
+	const int32_t position = trajectory.origin + m_jog_direction * static_cast<int32_t>(done);
+	const uint32_t start_cycles =
+		trajectory.start_cycles + k_ns_to_cyc_floor32(done * trajectory.interval_ns);
+
+	/* Leave room to stop before the end of travel, one tick ahead. */
+	const MotionProfile profile = motion_profile();
+	const int32_t limit = (m_jog_direction > 0) ? 0xFFFF : 0;
+	const uint32_t to_limit =
+		static_cast<uint32_t>((limit > position) ? (limit - position) : (position - limit));
+	const uint32_t margin = stopping_distance(m_jog_speed, profile) +
+				((m_jog_speed * static_cast<uint32_t>(kJogTickMs)) / 1000U) + 1U;
+	if (to_limit <= margin)
+	{
+		LOG_INF("Jog reached the end of travel");
+		decelerate_to_rest();
+		return;
+	}
+
+	uint32_t step = UINT32_MAX;
+	if (kAcceleration != 0U)
+	{
+		step = static_cast<uint32_t>((kAcceleration * static_cast<uint64_t>(now_ms - m_jog_ramp_ms)) /
+					     1000U);
+		if (step == 0U)
+		{
+			/* Too soon after the last change; let the time add up. */
+			return;
+		}
+	}
+	m_jog_ramp_ms = now_ms;
+
+	uint32_t speed = m_jog_target_speed;
+	if (m_jog_speed < m_jog_target_speed)
+	{
+		speed = ((m_jog_target_speed - m_jog_speed) > step) ? (m_jog_speed + step) : speed;
+	}
+	else if (m_jog_speed > m_jog_target_speed)
+	{
+		speed = ((m_jog_speed - m_jog_target_speed) > step) ? (m_jog_speed - step) : speed;
+	}
+	if (speed == m_jog_speed)
+	{
+		return;
+	}
+
+	const MotionSegment segment{
+		.steps = to_limit,
+		.interval_ns = 1000000000ULL / speed,
+	};
+	if (apply_step_interval(segment.interval_ns) != 0)
+	{
+		set_fault();
+		decelerate_to_rest();
+		return;
+	}
+	m_jog_speed = speed;
+	publish_trajectory(position, segment, start_cycles);
+}
+
+void Focuser::decelerate_to_rest()
+{
+	const MotionProfile profile = motion_profile();
+	const uint32_t speed = current_speed();
+	const int32_t position = read_actual_position();
+	m_jog_direction = 0;
+
+	LOG_DBG("Decelerating from %u steps/s at %d", speed, position);
+	m_plan = plan_stop(speed, profile);
+	m_plan_index = 0U;
+	m_plan_position = position;
+	m_queued_move_ns = 0U;
+	if (!m_plan.empty() && start_next_segment())
+	{
+		m_reversing = true;
+		return;
+	}
+
+	/* Slow enough to stop on the spot; a pending request is taken next pass. */
+	(void)m_stepper.stop();
+	finish_motion(MoveEnd::completed);
+	k_sem_give(&m_state.move_sem);
+}
+
+bool Focuser::stepper_idle()
+{
+	bool moving = false;
+	const int ret = m_stepper.is_moving(moving);
+	if (ret != 0)
+	{
+		/* Treat a failing controller as idle rather than waiting forever. */
+		LOG_ERR("stepper_is_moving failed (%d)", ret);
+		return true;
+	}
+	return !moving;
+}
+
 int Focuser::apply_step_interval(uint64_t interval_ns)
 {
 	if (interval_ns == 0U)
@@ -380,17 +1338,25 @@ int32_t Focuser::read_actual_position()
 	if (ret != 0)
 	{
 		LOG_WRN("Failed to query actual position (%d)", ret);
-		uint16_t fallback = 0U;
-		{
-			MutexLock lock(m_state.lock);
-			fallback = m_state.desired_position;
-		}
-		return static_cast<int32_t>(fallback);
+
+		/* Extrapolated from m_state rather than m_snapshot: on the focuser
+		 * thread a load() could spin on a writer it preempted.
+		 */
+		MutexLock lock(m_state.lock);
+		return static_cast<int32_t>(position_at_locked(k_cycle_get_32()));
 	}
 	return actual;
 }
 
-void Focuser::restore_position()
+uint16_t Focuser::position_at_locked(uint32_t now_cycles) const
+{
+	Snapshot snapshot;
+	snapshot.position = m_state.desired_position;
+	snapshot.trajectory = m_state.trajectory;
+	return snapshot.position_at(now_cycles);
+}
+
+void Focuser::restore_state()
 {
 	if (m_store == nullptr)
 	{
@@ -398,16 +1364,25 @@ void Focuser::restore_position()
 		return;
 	}
 
-	uint16_t persisted = 0U;
-	if (m_store->load(persisted))
-	{
-		LOG_INF("Restoring focuser position 0x%04x (%u) from store", persisted, persisted);
-		applyCurrentPosition(persisted, false);
-	}
-	else
+	PersistentState persisted{};
+	if (!m_store->load(persisted))
 	{
-		LOG_INF("No persisted focuser position found, defaulting to 0");
+		LOG_INF("No persisted focuser state found, defaulting to position 0");
+		return;
 	}
+
+	LOG_INF("Restoring focuser position 0x%04x (%u), speed %u, %s step from store",
+		persisted.position, persisted.position, persisted.speed_multiplier,
+		persisted.half_step ? "half" : "full");
+	applyCurrentPosition(persisted.position, false);
+
+	MutexLock lock(m_state.lock);
+	m_state.speed_multiplier = (persisted.speed_multiplier == 0U) ? 1U : persisted.speed_multiplier;
+	m_state.half_step = persisted.half_step;
+	m_state.temperature_coeff_times2 = persisted.temperature_coeff_times2;
+	m_state.persisted = persisted;
+	update_timing_locked();
+	publish_locked();
 }
 
 void Focuser::applyCurrentPosition(uint16_t position, bool persist)
@@ -425,6 +1400,7 @@ void Focuser::applyCurrentPosition(uint16_t position, bool persist)
 		m_state.desired_position = position;
 		m_state.move_request = false;
 		m_state.cancel_move = false;
+		publish_locked();
 	}
 
 	if (persist)
@@ -439,13 +1415,23 @@ void Focuser::applyCurrentPosition(uint16_t position, bool persist)
 }
 
 void Focuser::save_position(uint16_t position)
+{
+	MutexLock lock(m_state.lock);
+	m_state.persisted.position = position;
+	persist_locked();
+}
+
+void Focuser::persist_locked()
 {
 	if (m_store == nullptr)
 	{
 		return;
 	}
 
-	m_store->save(position);
+	/* Saved under the state lock so concurrent savers cannot reorder their
+	 * snapshots; the configured stores only queue the write.
+	 */
+	m_store->save(m_state.persisted);
 }
 
 int Focuser::set_stepper_driver_enabled(bool enable)
@@ -4,48 +4,189 @@
 
 #include <Moonlite.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <string>
+#include <string_view>
 
 #include "FocuserStepper.hpp"
+#include "MotionPlanner.hpp"
 #include "PositionStore.hpp"
+#include "Seqlock.hpp"
 
 class Focuser final : public moonlite::Handler
 {
 public:
+	/* Constant-speed segment the motor is executing, timed from its start. */
+	struct Trajectory
+	{
+		int32_t origin{0};
+		/* +1 or -1 while a segment runs, 0 at rest. */
+		int32_t direction{0};
+		uint32_t steps{0U};
+		uint64_t interval_ns{0U};
+		uint32_t start_cycles{0U};
+		/* Planned time of the motion that follows this segment. */
+		uint64_t following_ns{0U};
+	};
+
+	/* Points a motion program (XA) can hold. */
+	static constexpr std::size_t kMaxProgramPoints = CONFIG_APP_FOCUSER_PROGRAM_POINTS;
+
+	/* Timing of one point of the last motion program run. */
+	struct ProgramPointStats
+	{
+		/* Move time the planner expected, from rest to rest. */
+		uint32_t planned_ms{0U};
+		/* From leaving the previous point (or starting the program) to arrival. */
+		uint32_t move_ms{0U};
+		/* Time spent at the point before moving on. */
+		uint32_t dwell_ms{0U};
+	};
+
+	/* Consistent view of the state that read-only Moonlite queries serve. */
+	struct Snapshot
+	{
+		/* Position at rest or at the start of the current segment. */
+		uint16_t position{0U};
+		uint16_t new_position{0U};
+		uint16_t target{0U};
+		bool moving{false};
+		bool half_step{false};
+		/* The last move could not be started by the stepper driver. */
+		bool fault{false};
+		/* A requested move the focuser thread has not picked up yet. */
+		bool move_pending{false};
+		bool program_running{false};
+		/* Running open-ended on XJ; the trajectory ends at the limit of travel. */
+		bool jogging{false};
+		uint8_t speed{1U};
+		uint64_t step_interval_ns{0U};
+		int8_t temperature_coeff_times2{0};
+		Trajectory trajectory{};
+
+		/* Position extrapolated along the trajectory at cycle count now;
+		 * exact to within one step for a controller that keeps time.
+		 */
+		uint16_t position_at(uint32_t now_cycles) const;
+		/* Planned time until the requested motion ends; 0 when at rest or jogging. */
+		uint64_t remaining_ns_at(uint32_t now_cycles) const;
+	};
+
+	/* Called from the focuser thread when a move ends, once notifications
+	 * have been enabled with XN; position is where the focuser came to rest.
+	 */
+	using NotificationCallback = void (*)(moonlite::Notification notification, uint16_t position,
+					      void *user_data);
+
+	/* Called from the parsing thread on XB; returns whether the link can
+	 * switch to baud once the reply has been sent.
+	 */
+	using BaudRateCallback = bool (*)(uint32_t baud, void *user_data);
+
 	explicit Focuser(FocuserStepper &stepper, PositionStore *store, const char *firmware_version);
 
 	int initialise();
 	void loop();
 
+	/* Waits up to timeout for a request or motion event and handles it.
+	 * Returns 0 when something was processed and -EAGAIN on timeout.
+	 */
+	int run_once(k_timeout_t timeout);
+
+	/* Lock-free; never blocks on the state mutex or touches the stepper.
+	 * Not for the focuser thread; see m_snapshot.
+	 */
+	Snapshot snapshot() const
+	{
+		return m_snapshot.load();
+	}
+
+	/* Registers where notification frames go; set once before the threads start. */
+	void set_notification_callback(NotificationCallback callback, void *user_data);
+	/* Registers who handles XB; without one every rate is refused. */
+	void set_baud_rate_callback(BaudRateCallback callback, void *user_data);
+
+	/* Timing of point index in the last program run; zero if not reached. */
+	ProgramPointStats program_point_stats(std::size_t index);
+
 	void stop() override;
 	uint16_t getCurrentPosition() override;
 	void setCurrentPosition(uint16_t position) override;
 	uint16_t getNewPosition() override;
 	void setNewPosition(uint16_t position) override;
 	void goToNewPosition() override;
+	void goToPosition(uint16_t position) override;
+	void moveRelative(int16_t delta) override;
 	bool isHalfStep() override;
 	void setHalfStep(bool enabled) override;
 	bool isMoving() override;
-	std::string getFirmwareVersion() override;
+	std::string_view getFirmwareVersion() override;
 	uint8_t getSpeed() override;
 	void setSpeed(uint8_t speed) override;
 	uint16_t getTemperature() override;
 	uint8_t getTemperatureCoefficientRaw() override;
+	moonlite::Status getStatus() override;
+	void setNotifications(bool enabled) override;
+	bool setBaudRate(uint32_t baud) override;
+	uint32_t getRemainingMoveTime() override;
+	void clearProgram() override;
+	void setProgramDwell(uint16_t dwell_ms) override;
+	void addProgramPoint(uint16_t position) override;
+	void runProgram() override;
+	uint32_t getProgramPointTime(uint8_t index) override;
+	void jog(int16_t rate) override;
 
 private:
+	struct ProgramPoint
+	{
+		uint16_t target{0U};
+		uint16_t dwell_ms{0U};
+	};
+
 	struct FocuserState
 	{
 		k_mutex lock{};
 		k_sem move_sem{};
+		k_poll_signal motion_signal{};
 		bool move_request{false};
 		bool cancel_move{false};
 		uint64_t step_interval_ns{500000U};
 		uint16_t staged_position{0U};
 		uint16_t desired_position{0U};
+		/* Target of the pending move request; unlike desired_position it is
+		 * not rewritten by position queries while a request waits.
+		 */
+		uint16_t move_target{0U};
+		bool moving{false};
+		bool fault{false};
+		Trajectory trajectory{};
 		uint8_t speed_multiplier{1U};
 		bool half_step{false};
 		int8_t temperature_coeff_times2{0};
+		/* Last state handed to the store; position only changes at rest. */
+		PersistentState persisted{};
+		/* Program uploaded with XC/XW/XA; the focuser thread copies it on XP. */
+		std::array<ProgramPoint, kMaxProgramPoints> program{};
+		std::size_t program_length{0U};
+		uint16_t program_dwell_ms{0U};
+		bool program_request{false};
+		bool program_running{false};
+		std::array<ProgramPointStats, kMaxProgramPoints> program_stats{};
+		/* Latest XJ frame; the focuser thread drops it past its deadline. */
+		bool jog_request{false};
+		int16_t jog_rate{0};
+		int64_t jog_deadline_ms{0};
+		bool jogging{false};
+	};
+
+	/* Why finish_motion() ends a move; a superseded move is followed by another. */
+	enum class MoveEnd : uint8_t
+	{
+		completed,
+		cancelled,
+		superseded,
 	};
 
 	class MutexLock
@@ -65,19 +206,97 @@ private:
 		k_mutex &m_mutex;
 	};
 
+	static void on_stepper_event(FocuserStepper::Event event, void *user_data);
+
 	void update_timing_locked();
+	/* Hands target to the focuser thread; the caller gives move_sem after unlocking. */
+	void request_move_locked(uint16_t target);
+	void publish_locked();
+	void publish_position(int32_t position);
+	void publish_trajectory(int32_t origin, const MotionSegment &segment, uint32_t start_cycles);
+	/* Moves the trajectory origin forward before the cycle counter can wrap. */
+	void rebase_trajectory();
 	void init();
-	void move_to(uint16_t target);
+	void process_requests();
+	MotionProfile motion_profile();
+	uint32_t current_speed() const;
+	void load_plan(int32_t origin, uint16_t target, const MotionProfile &profile,
+		       uint32_t initial_speed);
+	void start_motion(uint16_t target);
+	void retarget(uint16_t target);
+	bool start_next_segment();
+	/* Flags the move as failed until the next one starts. */
+	void set_fault();
+	void finish_motion(MoveEnd end);
+	void notify(moonlite::Notification notification, uint16_t position);
+	/* Routes the end of a move to the running program, if any, or to notify(). */
+	void report_move_end(moonlite::Notification notification, uint16_t position);
+	void start_program();
+	void start_program_point();
+	void program_point_reached(uint16_t position);
+	/* Called once the dwell at the current point is over. */
+	void advance_program();
+	void end_program();
+	void handle_jog(int16_t rate, int64_t deadline_ms);
+	void start_jog(int32_t direction, uint32_t speed);
+	/* Keepalive, limit and ramp checks; called every kJogTickMs while jogging. */
+	void update_jog();
+	/* Plans a stop from the current speed; pending requests start once at rest. */
+	void decelerate_to_rest();
+	bool stepper_idle();
 	int apply_step_interval(uint64_t interval_ns);
 	int32_t read_actual_position();
+	uint16_t position_at_locked(uint32_t now_cycles) const;
 	int set_stepper_driver_enabled(bool enable);
-	void restore_position();
+	void restore_state();
 	void applyCurrentPosition(uint16_t position, bool persist);
 	void save_position(uint16_t position);
+	void persist_locked();
 
 	const char *m_firmware_version;
 
 	FocuserState m_state{};
+	/* Republished from m_state under m_state.lock after every change, from
+	 * either thread. Only the UART thread may load() it: it never preempts
+	 * the focuser thread, whereas a focuser-thread load() could spin forever
+	 * on a UART-thread writer it preempted. The focuser thread reads m_state
+	 * under m_state.lock instead.
+	 */
+	Seqlock<Snapshot> m_snapshot{};
 	FocuserStepper &m_stepper;
 	PositionStore *m_store;
+
+	NotificationCallback m_notification_callback{nullptr};
+	void *m_notification_user_data{nullptr};
+	BaudRateCallback m_baud_rate_callback{nullptr};
+	void *m_baud_rate_user_data{nullptr};
+	/* Set by XN from the UART thread, read by the focuser thread. */
+	std::atomic<bool> m_notifications{false};
+
+	/* Written by the focuser thread only. */
+	std::atomic<bool> m_motion_active{false};
+	bool m_motion_events{false};
+	MotionPlan m_plan{};
+	std::size_t m_plan_index{0U};
+	int32_t m_plan_position{0};
+	int32_t m_plan_direction{1};
+	/* Decelerating to rest; the pending request starts once stopped. */
+	bool m_reversing{false};
+	/* Planned time of the move that starts once the reversal has stopped. */
+	uint64_t m_queued_move_ns{0U};
+	/* Motion program being run, copied from m_state.program on XP. */
+	std::array<ProgramPoint, kMaxProgramPoints> m_program{};
+	std::size_t m_program_length{0U};
+	std::size_t m_program_index{0U};
+	bool m_program_active{false};
+	/* Resting at m_program[m_program_index] until its dwell is over. */
+	bool m_program_dwelling{false};
+	int64_t m_point_start_ms{0};
+	int64_t m_point_arrival_ms{0};
+	/* Running on m_stepper.run(): +1 or -1, 0 otherwise. */
+	int32_t m_jog_direction{0};
+	uint32_t m_jog_speed{0U};
+	uint32_t m_jog_target_speed{0U};
+	int64_t m_jog_deadline_ms{0};
+	int64_t m_jog_ramp_ms{0};
 };
@@ -8,6 +8,24 @@
 class FocuserStepper
 {
 public:
+    // Motion events reported asynchronously by the controller.
+    enum class Event
+    {
+        steps_completed,
+        stopped,
+        other,
+    };
+
+    // Direction of continuous motion started by run().
+    enum class Direction
+    {
+        positive,
+        negative,
+    };
+
+    // Called from the controller's context, possibly an ISR; keep it short.
+    using EventCallback = void (*)(Event event, void *user_data);
+
     virtual ~FocuserStepper() = default;
 
     // Returns true when both the stepper controller and driver can be used.
@@ -22,6 +40,10 @@ public:
     // Begins motion toward the requested target position.
     virtual int move_to(int32_t target) = 0;
 
+    // Steps continuously in direction at the current microstep interval
+    // until stop() or move_to() is called.
+    virtual int run(Direction direction) = 0;
+
     // Queries whether the controller is currently moving.
     virtual int is_moving(bool &moving) = 0;
 
@@ -33,4 +55,8 @@ public:
 
     // Enables or disables the external stepper driver if present.
     virtual int enable_driver(bool enable) = 0;
+
+    // Registers a callback for motion events. A non-zero return means the
+    // controller cannot report them and callers must poll is_moving() instead.
+    virtual int set_event_callback(EventCallback callback, void *user_data) = 0;
 };
@@ -0,0 +1,203 @@
+#include "MotionPlanner.hpp"
+
+namespace
+{
+	constexpr uint64_t kNsPerSecond = 1000000000ULL;
+
+	uint32_t isqrt(uint64_t value)
+	{
+		uint64_t root = 0U;
+		uint64_t bit = 1ULL << 62;
+		while (bit > value)
+		{
+			bit >>= 2;
+		}
+
+		while (bit != 0U)
+		{
+			if (value >= root + bit)
+			{
+				value -= root + bit;
+				root = (root >> 1) + bit;
+			}
+			else
+			{
+				root >>= 1;
+			}
+			bit >>= 2;
+		}
+		return static_cast<uint32_t>(root);
+	}
+
+	/* Steps needed to accelerate from `from` to `to` (v^2 = v0^2 + 2ad), rounded. */
+	uint32_t ramp_distance(uint32_t from, uint32_t to, uint32_t acceleration)
+	{
+		const uint64_t delta = (static_cast<uint64_t>(to) * to) - (static_cast<uint64_t>(from) * from);
+		return static_cast<uint32_t>((delta + acceleration) / (2ULL * acceleration));
+	}
+
+	uint32_t effective_start_speed(const MotionProfile &profile)
+	{
+		return (profile.start_speed == 0U) ? 1U : profile.start_speed;
+	}
+
+	/* Appends a ramp between low and high speed covering steps, split into
+	 * equal speed increments that each run at their mean speed, except the
+	 * first stage with steps, which runs at low so a move never starts or
+	 * ends above the start speed. Stage boundaries use cumulative rounded
+	 * distances so the stages add up to exactly steps; a descending ramp
+	 * mirrors the ascending one.
+	 */
+	void append_ramp(MotionPlan &plan, uint32_t low, uint32_t high, uint32_t steps,
+			 uint32_t acceleration, bool descending)
+	{
+		std::array<uint32_t, MotionPlan::kRampStages> stage_steps{};
+		std::array<uint32_t, MotionPlan::kRampStages> stage_speed{};
+		uint32_t covered = 0U;
+		for (std::size_t i = 0; i < MotionPlan::kRampStages; ++i)
+		{
+			const uint32_t from = low + static_cast<uint32_t>(
+				(static_cast<uint64_t>(high - low) * i) / MotionPlan::kRampStages);
+			const uint32_t to = low + static_cast<uint32_t>(
+				(static_cast<uint64_t>(high - low) * (i + 1U)) / MotionPlan::kRampStages);
+			uint32_t boundary = ramp_distance(low, to, acceleration);
+			if ((boundary > steps) || (i + 1U == MotionPlan::kRampStages))
+			{
+				boundary = steps;
+			}
+			stage_steps[i] = boundary - covered;
+			stage_speed[i] = (covered == 0U) ? low : ((from + to) / 2U);
+			covered = boundary;
+		}
+
+		for (std::size_t i = 0; i < MotionPlan::kRampStages; ++i)
+		{
+			const std::size_t stage = descending ? (MotionPlan::kRampStages - 1U - i) : i;
+			plan.append(stage_steps[stage], stage_speed[stage]);
+		}
+	}
+
+} // namespace
+
+uint32_t MotionPlan::total_steps() const
+{
+	uint32_t total = 0U;
+	for (std::size_t i = 0; i < m_count; ++i)
+	{
+		total += m_segments[i].steps;
+	}
+	return total;
+}
+
+uint64_t MotionPlan::duration_us() const
+{
+	uint64_t total_ns = 0U;
+	for (std::size_t i = 0; i < m_count; ++i)
+	{
+		total_ns += static_cast<uint64_t>(m_segments[i].steps) * m_segments[i].interval_ns;
+	}
+	return total_ns / 1000U;
+}
+
+void MotionPlan::append(uint32_t steps, uint32_t speed)
+{
+	if ((steps == 0U) || (m_count == kMaxSegments))
+	{
+		return;
+	}
+
+	const uint64_t interval_ns = kNsPerSecond / ((speed == 0U) ? 1U : speed);
+	if ((m_count > 0U) && (m_segments[m_count - 1U].interval_ns == interval_ns))
+	{
+		m_segments[m_count - 1U].steps += steps;
+		return;
+	}
+
+	m_segments[m_count].steps = steps;
+	m_segments[m_count].interval_ns = interval_ns;
+	++m_count;
+}
+
+MotionPlan plan_move(uint32_t distance, const MotionProfile &profile, uint32_t initial_speed)
+{
+	MotionPlan plan;
+	if (distance == 0U)
+	{
+		return plan;
+	}
+
+	const uint32_t start_speed = effective_start_speed(profile);
+	if ((profile.acceleration == 0U) || (profile.max_speed <= start_speed))
+	{
+		plan.append(distance, profile.max_speed);
+		return plan;
+	}
+
+	uint32_t entry_speed = (initial_speed < start_speed) ? start_speed : initial_speed;
+	if (entry_speed > profile.max_speed)
+	{
+		entry_speed = profile.max_speed;
+	}
+
+	/* Peak where the ramp up from entry_speed meets the ramp down to
+	 * start_speed; triangular when the move is too short for max_speed.
+	 */
+	const uint64_t entry_sq = static_cast<uint64_t>(entry_speed) * entry_speed;
+	const uint64_t start_sq = static_cast<uint64_t>(start_speed) * start_speed;
+	const uint32_t reachable =
+		isqrt(((2ULL * profile.acceleration * distance) + entry_sq + start_sq) / 2U);
+	uint32_t peak_speed = (reachable < profile.max_speed) ? reachable : profile.max_speed;
+	if (peak_speed < entry_speed)
+	{
+		peak_speed = entry_speed;
+	}
+
+	uint32_t up_steps = ramp_distance(entry_speed, peak_speed, profile.acceleration);
+	uint32_t down_steps = ramp_distance(start_speed, peak_speed, profile.acceleration);
+	if (up_steps + down_steps > distance)
+	{
+		if (entry_speed == start_speed)
+		{
+			/* Keep a move from rest symmetric. */
+			up_steps = distance / 2U;
+			down_steps = distance / 2U;
+		}
+		else
+		{
+			down_steps = (down_steps < distance) ? down_steps : distance;
+			up_steps = distance - down_steps;
+		}
+	}
+
+	if ((up_steps == 0U) && (down_steps == 0U))
+	{
+		plan.append(distance, entry_speed);
+		return plan;
+	}
+
+	append_ramp(plan, entry_speed, peak_speed, up_steps, profile.acceleration, false);
+	plan.append(distance - up_steps - down_steps, peak_speed);
+	append_ramp(plan, start_speed, peak_speed, down_steps, profile.acceleration, true);
+	return plan;
+}
+
+uint32_t stopping_distance(uint32_t speed, const MotionProfile &profile)
+{
+	const uint32_t start_speed = effective_start_speed(profile);
+	if ((profile.acceleration == 0U) || (speed <= start_speed))
+	{
+		return 0U;
+	}
+	return ramp_distance(start_speed, speed, profile.acceleration);
+}
+
+MotionPlan plan_stop(uint32_t speed, const MotionProfile &profile)
+{
+	MotionPlan plan;
+	const uint32_t steps = stopping_distance(speed, profile);
+	if (steps > 0U)
+	{
+		append_ramp(plan, effective_start_speed(profile), speed, steps, profile.acceleration, true);
+	}
+	return plan;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Speed limits of one move; speeds are in steps/s, acceleration in steps/s^2. */
+struct MotionProfile
+{
+	uint32_t max_speed{0U};
+	/* Speed the motor can start and stop at without ramping. */
+	uint32_t start_speed{0U};
+	/* Zero disables ramping: the whole move runs at max_speed. */
+	uint32_t acceleration{0U};
+};
+
+/* A run of steps executed at one constant step interval. */
+struct MotionSegment
+{
+	uint32_t steps{0U};
+	uint64_t interval_ns{0U};
+};
+
+/* Precomputed acceleration / cruise / deceleration ramp for one move. The
+ * ramps are split into a few constant-speed stages so a plain step/dir
+ * controller can follow them with set_microstep_interval() updates.
+ */
+class MotionPlan
+{
+public:
+	static constexpr std::size_t kRampStages = 8U;
+	static constexpr std::size_t kMaxSegments = (2U * kRampStages) + 1U;
+
+	std::size_t size() const
+	{
+		return m_count;
+	}
+
+	bool empty() const
+	{
+		return m_count == 0U;
+	}
+
+	const MotionSegment &operator[](std::size_t index) const
+	{
+		return m_segments[index];
+	}
+
+	uint32_t total_steps() const;
+	/* Time the plan takes when every segment runs at its nominal interval. */
+	uint64_t duration_us() const;
+
+	void append(uint32_t steps, uint32_t speed);
+
+private:
+	std::array<MotionSegment, kMaxSegments> m_segments{};
+	std::size_t m_count{0U};
+};
+
+/* Plans a move of distance steps that ends at profile.start_speed. A move
+ * that is already under way passes its current speed as initial_speed; it
+ * must have at least stopping_distance(initial_speed) steps left.
+ */
+MotionPlan plan_move(uint32_t distance, const MotionProfile &profile, uint32_t initial_speed = 0U);
+
+/* Steps needed to slow down from speed to profile.start_speed. */
+uint32_t stopping_distance(uint32_t speed, const MotionProfile &profile);
+
+/* Decelerates from speed to profile.start_speed over stopping_distance(speed) steps. */
+MotionPlan plan_stop(uint32_t speed, const MotionProfile &profile);
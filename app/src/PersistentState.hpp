@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Focuser state that survives a reboot, so a reconnecting client does not
+ * have to resend SD/SH before it can work.
+ */
+struct PersistentState
+{
+	uint16_t position{0U};
+	uint8_t speed_multiplier{1U};
+	bool half_step{false};
+	int8_t temperature_coeff_times2{0};
+
+	bool operator==(const PersistentState &) const = default;
+};
+
+/* Byte layout shared by every store. Fields are only ever appended: records
+ * carry their payload length, readers decode the prefix they know and keep
+ * defaults for fields a shorter (older) record lacks, and ignore bytes a
+ * longer (newer) record adds. Bump kVersion whenever a field is appended.
+ */
+namespace persistent_state
+{
+
+constexpr uint8_t kVersion = 1U;
+/* Payload room reserved in every record format for appended fields. */
+constexpr std::size_t kCapacity = 8U;
+
+constexpr std::size_t kPositionOffset = 0U;
+constexpr std::size_t kSpeedOffset = 2U;
+constexpr std::size_t kFlagsOffset = 3U;
+constexpr std::size_t kTemperatureCoeffOffset = 4U;
+constexpr std::size_t kEncodedSize = 5U;
+
+constexpr uint8_t kFlagHalfStep = 0x01U;
+
+static_assert(kEncodedSize <= kCapacity, "payload no longer fits the record formats");
+
+/* Writes the current layout into payload and returns its length. */
+inline uint8_t encode(const PersistentState &state, uint8_t (&payload)[kCapacity])
+{
+	for (uint8_t &byte : payload)
+	{
+		byte = 0U;
+	}
+	payload[kPositionOffset] = static_cast<uint8_t>(state.position & 0xFFU);
+	payload[kPositionOffset + 1U] = static_cast<uint8_t>(state.position >> 8);
+	payload[kSpeedOffset] = state.speed_multiplier;
+	payload[kFlagsOffset] = state.half_step ? kFlagHalfStep : 0U;
+	payload[kTemperatureCoeffOffset] = static_cast<uint8_t>(state.temperature_coeff_times2);
+	return static_cast<uint8_t>(kEncodedSize);
+}
+
+/* Decodes the first length bytes; returns false if even the position is missing. */
+inline bool decode(const uint8_t *payload, std::size_t length, PersistentState &state_out)
+{
+	if (length > kCapacity)
+	{
+		length = kCapacity;
+	}
+	if (length < (kPositionOffset + 2U))
+	{
+		return false;
+	}
+
+	PersistentState state{};
+	state.position = static_cast<uint16_t>(payload[kPositionOffset] |
+					       (payload[kPositionOffset + 1U] << 8));
+	if (length > kSpeedOffset)
+	{
+		state.speed_multiplier = (payload[kSpeedOffset] == 0U) ? 1U : payload[kSpeedOffset];
+	}
+	if (length > kFlagsOffset)
+	{
+		state.half_step = (payload[kFlagsOffset] & kFlagHalfStep) != 0U;
+	}
+	if (length > kTemperatureCoeffOffset)
+	{
+		state.temperature_coeff_times2 = static_cast<int8_t>(payload[kTemperatureCoeffOffset]);
+	}
+
+	state_out = state;
+	return true;
+}
+
+} // namespace persistent_state
@@ -2,11 +2,25 @@
 
 #include <cstdint>
 
+#include "PersistentState.hpp"
+
+/* Persists the focuser position together with the rest of PersistentState. */
 class PositionStore
 {
 public:
 	virtual ~PositionStore() = default;
 
-	virtual bool load(uint16_t &position_out) = 0;
-	virtual void save(uint16_t position) = 0;
+	virtual bool load(PersistentState &state_out) = 0;
+	virtual void save(const PersistentState &state) = 0;
+
+	/* Writes any deferred state to the backing storage before returning. */
+	virtual void flush()
+	{
+	}
+
+	/* Hint from the focuser; stores may hold writes back while it is moving. */
+	virtual void set_motion_active(bool active)
+	{
+		static_cast<void>(active);
+	}
 };
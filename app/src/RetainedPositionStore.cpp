@@ -0,0 +1,90 @@
+#include "RetainedPositionStore.hpp"
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+#include <cstddef>
+
+LOG_MODULE_DECLARE(position_store, CONFIG_APP_LOG_LEVEL);
+
+namespace
+{
+
+constexpr uint32_t kRetainedMagic = 0x52504F53U; // "RPOS"
+
+} // namespace
+
+RetainedPositionStore::RetainedPositionStore(PositionStore &backing, Block &block)
+	: m_backing(backing), m_block(block)
+{
+}
+
+bool RetainedPositionStore::load(PersistentState &state_out)
+{
+	const Block block = m_block;
+	if ((block.magic == kRetainedMagic) && (block.crc == block_crc(block)) &&
+	    persistent_state::decode(block.payload, block.length, state_out))
+	{
+		m_last_source = Source::retained;
+		return true;
+	}
+
+	if (!m_backing.load(state_out))
+	{
+		m_last_source = Source::none;
+		return false;
+	}
+
+	/* Cold boot: seed the block so the next warm reset skips the backing store. */
+	store_block(state_out);
+	m_last_source = Source::backing;
+	return true;
+}
+
+void RetainedPositionStore::save(const PersistentState &state)
+{
+	store_block(state);
+	m_backing.save(state);
+}
+
+void RetainedPositionStore::flush()
+{
+	m_backing.flush();
+}
+
+void RetainedPositionStore::set_motion_active(bool active)
+{
+	m_backing.set_motion_active(active);
+}
+
+const char *RetainedPositionStore::source_name(Source source)
+{
+	switch (source)
+	{
+	case Source::retained:
+		return "retained RAM";
+	case Source::backing:
+		return "storage";
+	case Source::none:
+	default:
+		return "none";
+	}
+}
+
+uint32_t RetainedPositionStore::block_crc(const Block &block)
+{
+	return crc32_ieee(reinterpret_cast<const uint8_t *>(&block), offsetof(Block, crc));
+}
+
+void RetainedPositionStore::store_block(const PersistentState &state)
+{
+	/* A reset part way through leaves a CRC mismatch, which load() treats as
+	 * a cold boot and answers from the backing store.
+	 */
+	Block block{};
+	block.magic = kRetainedMagic;
+	block.version = persistent_state::kVersion;
+	block.length = persistent_state::encode(state, block.payload);
+	block.crc = block_crc(block);
+	m_block = block;
+}
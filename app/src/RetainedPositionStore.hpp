@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PositionStore.hpp"
+
+/* Decorator that mirrors every saved state into a RAM block which survives
+ * warm resets (watchdog, sys_reboot(SYS_REBOOT_WARM), fault recovery). load()
+ * serves the state from that block without touching the backing store and
+ * only falls back to it when the block does not validate, i.e. on cold boot.
+ */
+class RetainedPositionStore final : public PositionStore
+{
+public:
+	/* Lives in a __noinit section; contents are validated, never initialised. */
+	struct Block
+	{
+		uint32_t magic;
+		uint8_t version;
+		uint8_t length;
+		uint16_t reserved;
+		uint8_t payload[persistent_state::kCapacity];
+		uint32_t crc;
+	};
+
+	enum class Source
+	{
+		none,
+		retained,
+		backing,
+	};
+
+	RetainedPositionStore(PositionStore &backing, Block &block);
+
+	RetainedPositionStore(const RetainedPositionStore &) = delete;
+	RetainedPositionStore &operator=(const RetainedPositionStore &) = delete;
+
+	bool load(PersistentState &state_out) override;
+	void save(const PersistentState &state) override;
+	void flush() override;
+	void set_motion_active(bool active) override;
+
+	/* Where the most recent load() found its state. */
+	Source last_load_source() const
+	{
+		return m_last_source;
+	}
+
+	static const char *source_name(Source source);
+
+private:
+	static uint32_t block_crc(const Block &block);
+	void store_block(const PersistentState &state);
+
+	PositionStore &m_backing;
+	Block &m_block;
+	Source m_last_source{Source::none};
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Sequence lock publishing a small trivially copyable value. Writers must be
+// serialized externally (e.g. by the mutex guarding the source data); readers
+// never block and simply retry if a write overlapped their copy. Only atomic
+// loads, stores and fences are used, so it works on cores without atomic
+// read-modify-write instructions.
+//
+// A reader spins while a write is in progress, so a reader must never be able
+// to preempt a writer: readers have to run at a lower or equal priority than
+// every writer, or in the writer's own thread.
+template <typename T>
+class Seqlock
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied bytewise");
+
+public:
+	// Writer side: publishes value; callers must serialize stores.
+	void store(const T &value)
+	{
+		const std::uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+		m_sequence.store(sequence + 1U, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(&m_value, &value, sizeof(T));
+		m_sequence.store(sequence + 2U, std::memory_order_release);
+	}
+
+	// Reader side: returns a consistent copy of the last published value.
+	T load() const
+	{
+		T copy;
+		std::uint32_t before = 0U;
+		std::uint32_t after = 0U;
+		do
+		{
+			before = m_sequence.load(std::memory_order_acquire);
+			std::memcpy(&copy, &m_value, sizeof(T));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = m_sequence.load(std::memory_order_relaxed);
+		} while (((before & 1U) != 0U) || (before != after));
+		return copy;
+	}
+
+	// Number of completed stores times two; odd while a store is in progress.
+	std::uint32_t sequence() const
+	{
+		return m_sequence.load(std::memory_order_acquire);
+	}
+
+private:
+	std::atomic<std::uint32_t> m_sequence{0U};
+	T m_value{};
+};
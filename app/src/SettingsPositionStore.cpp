@@ -0,0 +1,114 @@
+#include "SettingsPositionStore.hpp"
+
+#include <zephyr/logging/log.h>
+
+#include <cstddef>
+
+LOG_MODULE_DECLARE(position_store, CONFIG_APP_LOG_LEVEL);
+
+namespace
+{
+
+constexpr std::size_t kHeaderSize = 2U;
+
+} // namespace
+
+SettingsPositionStore::SettingsPositionStore(const char *key) : m_key(key)
+{
+}
+
+bool SettingsPositionStore::load(PersistentState &state_out)
+{
+	if (!ensure_ready())
+	{
+		return false;
+	}
+
+	LoadContext context{};
+	context.length = -ENOENT;
+	const int ret = settings_load_subtree_direct(m_key, &SettingsPositionStore::load_entry, &context);
+	if (ret != 0)
+	{
+		LOG_WRN("Failed to load %s from settings (%d)", m_key, ret);
+		return false;
+	}
+
+	if (context.length < static_cast<ssize_t>(kHeaderSize))
+	{
+		return false;
+	}
+
+	const std::size_t payload_length = static_cast<std::size_t>(context.length) - kHeaderSize;
+	const std::size_t length =
+		(context.record.length < payload_length) ? context.record.length : payload_length;
+	if (!persistent_state::decode(context.record.payload, length, state_out))
+	{
+		return false;
+	}
+
+	m_last_state = state_out;
+	m_has_value = true;
+	return true;
+}
+
+void SettingsPositionStore::save(const PersistentState &state)
+{
+	if (m_has_value && (state == m_last_state))
+	{
+		return;
+	}
+
+	if (!ensure_ready())
+	{
+		return;
+	}
+
+	Record record{};
+	record.version = persistent_state::kVersion;
+	record.length = persistent_state::encode(state, record.payload);
+
+	const int ret = settings_save_one(m_key, &record, kHeaderSize + record.length);
+	if (ret != 0)
+	{
+		LOG_ERR("Failed to save %s to settings (%d)", m_key, ret);
+		return;
+	}
+
+	m_last_state = state;
+	m_has_value = true;
+	LOG_DBG("Saved focuser position 0x%04x (%u) to settings", state.position, state.position);
+}
+
+int SettingsPositionStore::load_entry(const char *key, size_t length, settings_read_cb read_cb,
+				      void *cb_arg, void *param)
+{
+	const char *next = nullptr;
+	if (settings_name_next(key, &next) != 0)
+	{
+		/* A longer key below ours; not the state entry. */
+		return 0;
+	}
+
+	auto *context = static_cast<LoadContext *>(param);
+	/* Entries written by newer firmware may be longer; keep the known prefix. */
+	const size_t wanted = (length < sizeof(context->record)) ? length : sizeof(context->record);
+	context->length = read_cb(cb_arg, &context->record, wanted);
+	return 0;
+}
+
+bool SettingsPositionStore::ensure_ready()
+{
+	if (!m_ready)
+	{
+		const int ret = settings_subsys_init();
+		if (ret != 0)
+		{
+			LOG_ERR("Settings subsystem unavailable (%d)", ret);
+			return false;
+		}
+
+		m_ready = true;
+	}
+
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <zephyr/settings/settings.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "PositionStore.hpp"
+
+/* Keeps the focuser state as one entry of Zephyr's settings subsystem. The
+ * settings backend (NVS or ZMS on a flash partition) provides atomic writes,
+ * CRC checked entries and wear levelling, so this suits boards without an
+ * EEPROM.
+ */
+class SettingsPositionStore final : public PositionStore
+{
+public:
+	explicit SettingsPositionStore(const char *key = "focuser/state");
+
+	bool load(PersistentState &state_out) override;
+	void save(const PersistentState &state) override;
+
+private:
+	struct Record
+	{
+		uint8_t version;
+		uint8_t length;
+		uint8_t payload[persistent_state::kCapacity];
+	};
+
+	struct LoadContext
+	{
+		Record record;
+		ssize_t length;
+	};
+
+	static int load_entry(const char *key, size_t length, settings_read_cb read_cb, void *cb_arg,
+			      void *param);
+	bool ensure_ready();
+
+	const char *m_key;
+	bool m_ready{false};
+	bool m_has_value{false};
+	PersistentState m_last_state{};
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer byte ring. One context (e.g. an
+// ISR) may push while another (e.g. a thread) pops without any locking; the
+// indices are free-running and only ever written by their owning side, so
+// plain atomic loads and stores suffice, even on cores without atomic RMW.
+template <std::size_t Capacity>
+class SpscRing
+{
+	static_assert((Capacity != 0U) && ((Capacity & (Capacity - 1U)) == 0U),
+		      "capacity must be a power of two");
+
+public:
+	// Producer side: copies as many bytes as fit and returns how many were stored.
+	std::size_t push(const std::uint8_t *data, std::size_t length)
+	{
+		const std::uint32_t head = m_head.load(std::memory_order_relaxed);
+		const std::uint32_t tail = m_tail.load(std::memory_order_acquire);
+		const std::size_t space = Capacity - static_cast<std::size_t>(head - tail);
+		const std::size_t count = (length < space) ? length : space;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			m_storage[(head + i) & kMask] = data[i];
+		}
+
+		m_head.store(head + static_cast<std::uint32_t>(count), std::memory_order_release);
+		return count;
+	}
+
+	// Consumer side: copies up to capacity bytes out and returns how many were read.
+	std::size_t pop(std::uint8_t *data, std::size_t capacity)
+	{
+		const std::size_t count = peek(data, capacity);
+		skip(count);
+		return count;
+	}
+
+	// Consumer side: copies up to capacity bytes out without consuming them.
+	std::size_t peek(std::uint8_t *data, std::size_t capacity) const
+	{
+		const std::uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		const std::uint32_t head = m_head.load(std::memory_order_acquire);
+		const std::size_t available = static_cast<std::size_t>(head - tail);
+		const std::size_t count = (capacity < available) ? capacity : available;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			data[i] = m_storage[(tail + i) & kMask];
+		}
+		return count;
+	}
+
+	// Consumer side: releases count bytes previously returned by peek().
+	void skip(std::size_t count)
+	{
+		const std::uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		m_tail.store(tail + static_cast<std::uint32_t>(count), std::memory_order_release);
+	}
+
+	// Number of bytes currently buffered; exact only when called from either side.
+	std::size_t size() const
+	{
+		return static_cast<std::size_t>(m_head.load(std::memory_order_acquire) -
+						m_tail.load(std::memory_order_acquire));
+	}
+
+	bool empty() const
+	{
+		return size() == 0U;
+	}
+
+	static constexpr std::size_t capacity()
+	{
+		return Capacity;
+	}
+
+private:
+	static constexpr std::uint32_t kMask = static_cast<std::uint32_t>(Capacity - 1U);
+
+	std::atomic<std::uint32_t> m_head{0U};
+	std::atomic<std::uint32_t> m_tail{0U};
+	std::uint8_t m_storage[Capacity]{};
+};
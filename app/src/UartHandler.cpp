@@ -10,7 +10,9 @@ LOG_MODULE_REGISTER(uart_handler, CONFIG_APP_LOG_LEVEL);
 UartHandler::UartHandler(const struct device *uart)
 	: m_uart(uart), m_initialized(false)
 {
-	std::memset(&m_rx_queue, 0, sizeof(m_rx_queue));
+	std::memset(&m_rx_ready, 0, sizeof(m_rx_ready));
+	std::memset(&m_tx_space, 0, sizeof(m_tx_space));
+	std::memset(&m_tx_lock, 0, sizeof(m_tx_lock));
 }
 
 int UartHandler::init()
@@ -20,7 +22,9 @@ int UartHandler::init()
 		return 0;
 	}
 
-	k_msgq_init(&m_rx_queue, reinterpret_cast<char *>(m_rx_queue_storage), sizeof(std::uint8_t), kRxQueueDepth);
+	k_sem_init(&m_rx_ready, 0, 1);
+	k_sem_init(&m_tx_space, 0, 1);
+	k_mutex_init(&m_tx_lock);
 
 	if (!device_is_ready(m_uart))
 	{
@@ -35,52 +39,268 @@ int UartHandler::init()
 		return cb_rc;
 	}
 
+	struct uart_config config;
+	if (uart_config_get(m_uart, &config) == 0)
+	{
+		m_baud_rate = config.baudrate;
+	}
+
 	uart_irq_rx_enable(m_uart);
 	m_initialized = true;
 	return 0;
 }
 
-bool UartHandler::read_byte(std::uint8_t &byte, k_timeout_t timeout)
+bool UartHandler::flush_tx(k_timeout_t timeout)
 {
-	if (!m_initialized)
+	const k_timepoint_t deadline = sys_timepoint_calc(timeout);
+	while (!m_tx_ring.empty() || (uart_irq_tx_complete(m_uart) == 0))
 	{
+		if (sys_timepoint_expired(deadline))
+		{
+			return false;
+		}
+		k_usleep(100);
+	}
+	return true;
+}
+
+int UartHandler::set_baud_rate(std::uint32_t baud)
+{
+	struct uart_config config;
+	int ret = uart_config_get(m_uart, &config);
+	if (ret == 0)
+	{
+		config.baudrate = baud;
+		ret = uart_configure(m_uart, &config);
+	}
+	if (ret != 0)
+	{
+		LOG_ERR("Failed to set UART to %u baud (%d)", baud, ret);
+		return ret;
+	}
+
+	LOG_INF("UART now at %u baud (was %u)", baud, m_baud_rate);
+	m_baud_rate = baud;
+	return 0;
+}
+
+bool UartHandler::supports_baud_rate(std::uint32_t baud)
+{
+	struct uart_config config;
+	if (uart_config_get(m_uart, &config) != 0)
+	{
+		return false;
+	}
+	if (config.baudrate == baud)
+	{
+		return true;
+	}
+
+	const std::uint32_t current = config.baudrate;
+	config.baudrate = baud;
+	if (uart_configure(m_uart, &config) != 0)
+	{
+		LOG_INF("UART driver rejects %u baud", baud);
 		return false;
 	}
 
-	const int rc = k_msgq_get(&m_rx_queue, &byte, timeout);
-	return rc == 0;
+	config.baudrate = current;
+	const int ret = uart_configure(m_uart, &config);
+	if (ret != 0)
+	{
+		LOG_ERR("Failed to restore UART to %u baud (%d)", current, ret);
+	}
+	return true;
+}
+
+std::uint32_t UartHandler::baud_rate() const
+{
+	return m_baud_rate;
 }
 
-void UartHandler::write(const std::string &data)
+bool UartHandler::read_byte(std::uint8_t &byte, k_timeout_t timeout)
+{
+	return read(&byte, 1U, timeout) == 1U;
+}
+
+std::size_t UartHandler::read(std::uint8_t *buffer, std::size_t capacity, k_timeout_t timeout)
 {
-	for (char ch : data)
+	if (!m_initialized || (capacity == 0U))
 	{
-		write_char(ch);
+		return 0U;
 	}
+
+	const std::size_t count = m_rx_ring.pop(buffer, capacity);
+	if ((count > 0U) || K_TIMEOUT_EQ(timeout, K_NO_WAIT))
+	{
+		return count;
+	}
+
+	/* The ISR gives the semaphore once per burst (or once per completed
+	 * frame with CONFIG_APP_UART_FRAME_WAKEUP); a wakeup may find the ring
+	 * already drained by the previous read, so callers loop on 0.
+	 */
+	if (k_sem_take(&m_rx_ready, timeout) != 0)
+	{
+		return 0U;
+	}
+	m_rx_wakeups.store(m_rx_wakeups.load(std::memory_order_relaxed) + 1U,
+			   std::memory_order_relaxed);
+
+	return m_rx_ring.pop(buffer, capacity);
 }
 
-void UartHandler::write_char(char ch)
+void UartHandler::wake_reader()
+{
+	k_sem_give(&m_rx_ready);
+}
+
+std::uint32_t UartHandler::rx_dropped() const
+{
+	return m_rx_dropped.load(std::memory_order_relaxed);
+}
+
+std::uint32_t UartHandler::rx_wakeups() const
+{
+	return m_rx_wakeups.load(std::memory_order_relaxed);
+}
+
+std::uint32_t UartHandler::rx_frames() const
+{
+	return m_rx_frames.load(std::memory_order_relaxed);
+}
+
+void UartHandler::write(const std::string &data)
+{
+	write(data.data(), data.size());
+}
+
+void UartHandler::write(const char *data, std::size_t length)
 {
 	if (!m_initialized)
 	{
 		return;
 	}
 
-	uart_poll_out(m_uart, static_cast<unsigned char>(ch));
+	/* Queue the bytes and let the TX-ready interrupt drain them, so the
+	 * caller only waits when the ring itself is full.
+	 */
+	const auto *bytes = reinterpret_cast<const std::uint8_t *>(data);
+	std::size_t offset = 0U;
+	(void)k_mutex_lock(&m_tx_lock, K_FOREVER);
+	while (offset < length)
+	{
+		offset += m_tx_ring.push(&bytes[offset], length - offset);
+		uart_irq_tx_enable(m_uart);
+		if (offset < length)
+		{
+			(void)k_sem_take(&m_tx_space, K_FOREVER);
+		}
+	}
+	m_tx_writes.store(m_tx_writes.load(std::memory_order_relaxed) + 1U,
+			  std::memory_order_relaxed);
+	(void)k_mutex_unlock(&m_tx_lock);
+}
+
+bool UartHandler::try_write(const char *data, std::size_t length, k_timeout_t timeout)
+{
+	if (!m_initialized || (k_mutex_lock(&m_tx_lock, timeout) != 0))
+	{
+		return false;
+	}
+
+	/* Only the lock holder pushes, so the free space cannot shrink under us. */
+	const bool fits = (kTxRingSize - m_tx_ring.size()) >= length;
+	if (fits)
+	{
+		(void)m_tx_ring.push(reinterpret_cast<const std::uint8_t *>(data), length);
+		uart_irq_tx_enable(m_uart);
+		m_tx_writes.store(m_tx_writes.load(std::memory_order_relaxed) + 1U,
+				  std::memory_order_relaxed);
+	}
+	(void)k_mutex_unlock(&m_tx_lock);
+	return fits;
+}
+
+void UartHandler::write_char(char ch)
+{
+	write(&ch, 1U);
+}
+
+std::size_t UartHandler::rx_pending() const
+{
+	return m_rx_ring.size();
+}
+
+std::size_t UartHandler::tx_pending() const
+{
+	return m_tx_ring.size();
+}
+
+std::uint32_t UartHandler::tx_writes() const
+{
+	return m_tx_writes.load(std::memory_order_relaxed);
 }
 
-void UartHandler::push_rx_bytes(const std::uint8_t *data, int length)
+std::size_t UartHandler::push_rx_bytes(const std::uint8_t *data, std::size_t length)
 {
-	for (int i = 0; i < length; ++i)
+	const std::size_t stored = m_rx_ring.push(data, length);
+	if (stored < length)
 	{
-		const std::uint8_t byte = data[i];
-		const int rc = k_msgq_put(&m_rx_queue, &byte, K_NO_WAIT);
-		if (rc != 0)
+		/* Single writer: a plain load/store pair is enough and stays lock-free. */
+		m_rx_dropped.store(m_rx_dropped.load(std::memory_order_relaxed) +
+					   static_cast<std::uint32_t>(length - stored),
+				   std::memory_order_relaxed);
+	}
+	return stored;
+}
+
+std::uint32_t UartHandler::scan_frames(const std::uint8_t *data, std::size_t length)
+{
+	/* Mirrors the parser's framing: ':' (re)starts a frame, '#' closes an
+	 * open one, anything else outside a frame is ignored.
+	 */
+	std::uint32_t completed = 0U;
+	for (std::size_t i = 0; i < length; ++i)
+	{
+		if (data[i] == ':')
+		{
+			m_rx_in_frame = true;
+		}
+		else if ((data[i] == '#') && m_rx_in_frame)
 		{
-			LOG_WRN("UART handler RX queue full, dropping byte");
-			break;
+			m_rx_in_frame = false;
+			++completed;
 		}
 	}
+
+	if (completed > 0U)
+	{
+		m_rx_frames.store(m_rx_frames.load(std::memory_order_relaxed) + completed,
+				  std::memory_order_relaxed);
+	}
+	return completed;
+}
+
+void UartHandler::service_tx(const struct device *dev)
+{
+	std::uint8_t chunk[kTxBurstSize];
+	const std::size_t count = m_tx_ring.peek(chunk, sizeof(chunk));
+	if (count == 0U)
+	{
+		/* Nothing left to send. On a single core write() cannot run between
+		 * the empty check and the disable, and it re-enables after queuing.
+		 */
+		uart_irq_tx_disable(dev);
+		return;
+	}
+
+	const int sent = uart_fifo_fill(dev, chunk, static_cast<int>(count));
+	if (sent > 0)
+	{
+		m_tx_ring.skip(static_cast<std::size_t>(sent));
+		k_sem_give(&m_tx_space);
+	}
 }
 
 void UartHandler::uart_isr(const struct device *dev, void *user_data)
@@ -91,6 +311,8 @@ void UartHandler::uart_isr(const struct device *dev, void *user_data)
 		return;
 	}
 
+	bool received = false;
+	std::uint32_t frames = 0U;
 	while (uart_irq_update(dev) && uart_irq_is_pending(dev))
 	{
 		if (uart_irq_rx_ready(dev))
@@ -99,8 +321,29 @@ void UartHandler::uart_isr(const struct device *dev, void *user_data)
 			const int bytes_read = uart_fifo_read(dev, buffer, sizeof(buffer));
 			if (bytes_read > 0)
 			{
-				self->push_rx_bytes(buffer, bytes_read);
+				const std::size_t stored =
+					self->push_rx_bytes(buffer, static_cast<std::size_t>(bytes_read));
+				received |= (stored > 0U);
+				frames += self->scan_frames(buffer, stored);
 			}
 		}
+
+		if (uart_irq_tx_ready(dev))
+		{
+			self->service_tx(dev);
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_APP_UART_FRAME_WAKEUP))
+	{
+		/* Partial frames stay buffered until their '#' arrives; a half-full
+		 * ring still wakes the reader so unframed noise cannot fill it.
+		 */
+		received = (frames > 0U) || (self->m_rx_ring.size() >= (kRxRingSize / 2U));
+	}
+
+	if (received)
+	{
+		k_sem_give(&self->m_rx_ready);
 	}
 }
@@ -4,28 +4,94 @@
 #include <zephyr/drivers/uart.h>
 #include <zephyr/kernel.h>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <string>
 
+#include "SpscRing.hpp"
+
 class UartHandler {
 public:
+	/* Largest chunk moved from the UART FIFO in one ISR pass. */
+	static constexpr std::size_t kRxBurstSize = 8;
+
 	explicit UartHandler(const struct device *uart);
 
 	int init();
 	bool read_byte(std::uint8_t &byte, k_timeout_t timeout);
+	/* Waits up to timeout for data, then drains up to capacity buffered bytes. */
+	std::size_t read(std::uint8_t *buffer, std::size_t capacity, k_timeout_t timeout);
+	/* Ends a blocked read() early; it returns whatever is buffered, possibly 0. */
+	void wake_reader();
 	void write(const std::string &data);
+	void write(const char *data, std::size_t length);
 	void write_char(char ch);
+	/* Queues all of data or nothing, waiting at most timeout for another
+	 * writer; never waits for ring space. Returns false if not queued.
+	 */
+	bool try_write(const char *data, std::size_t length, k_timeout_t timeout);
+
+	/* Waits until every queued byte has left the transmitter; false on timeout. */
+	bool flush_tx(k_timeout_t timeout);
+
+	/* Reconfigures the line rate, keeping framing and flow control. */
+	int set_baud_rate(std::uint32_t baud);
+	/* Checks that the driver accepts baud by applying it and restoring the
+	 * current rate; call with TX drained and the peer silent.
+	 */
+	bool supports_baud_rate(std::uint32_t baud);
+	std::uint32_t baud_rate() const;
+
+	/* Total bytes dropped because the RX ring was full (monotonic, wraps at 2^32). */
+	std::uint32_t rx_dropped() const;
+
+	/* Bytes received but not yet returned by read(). */
+	std::size_t rx_pending() const;
+
+	/* Bytes queued for transmission but not yet handed to the UART FIFO. */
+	std::size_t tx_pending() const;
+
+	/* Successful write()/try_write() calls (monotonic); one per TX submission. */
+	std::uint32_t tx_writes() const;
+
+	/* Times read() had to block and was woken, by the ISR or wake_reader() (monotonic). */
+	std::uint32_t rx_wakeups() const;
+	/* Complete ':' ... '#' frames seen by the ISR (monotonic); together with
+	 * rx_wakeups() this gives the wakeups-per-frame ratio.
+	 */
+	std::uint32_t rx_frames() const;
 
 private:
 	static void uart_isr(const struct device *dev, void *user_data);
-	void push_rx_bytes(const std::uint8_t *data, int length);
+	std::size_t push_rx_bytes(const std::uint8_t *data, std::size_t length);
+	std::uint32_t scan_frames(const std::uint8_t *data, std::size_t length);
+	void service_tx(const struct device *dev);
 
-	static constexpr std::size_t kRxQueueDepth = 128;
-	static constexpr std::size_t kRxBurstSize = 8;
+	static constexpr std::size_t kRxRingSize = 128;
+	static constexpr std::size_t kTxRingSize = 128;
+	/* Largest chunk offered to the UART FIFO in one ISR pass. */
+	static constexpr std::size_t kTxBurstSize = 16;
+	/* Moonlite's stock rate, assumed if the driver cannot report its own. */
+	static constexpr std::uint32_t kDefaultBaudRate = 9600U;
 
 	const struct device *m_uart;
-	struct k_msgq m_rx_queue;
-	alignas(4) std::uint8_t m_rx_queue_storage[kRxQueueDepth];
+	SpscRing<kRxRingSize> m_rx_ring;
+	SpscRing<kTxRingSize> m_tx_ring;
+	struct k_sem m_rx_ready;
+	/* Given by the ISR whenever it frees TX ring space; write() waits on it when full. */
+	struct k_sem m_tx_space;
+	/* Serialises writers so each write() reaches the line contiguously. */
+	struct k_mutex m_tx_lock;
+	/* Written by the ISR only. */
+	std::atomic<std::uint32_t> m_rx_dropped{0U};
+	std::atomic<std::uint32_t> m_rx_frames{0U};
+	bool m_rx_in_frame{false};
+	/* Written by the reading thread only. */
+	std::atomic<std::uint32_t> m_rx_wakeups{0U};
+	/* Written under m_tx_lock only. */
+	std::atomic<std::uint32_t> m_tx_writes{0U};
+	/* Rate the UART runs at, read back from the driver at init(). */
+	std::uint32_t m_baud_rate{kDefaultBaudRate};
 	bool m_initialized;
 };
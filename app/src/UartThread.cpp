@@ -2,8 +2,9 @@
 
 #include <zephyr/logging/log.h>
 
+#include <cstddef>
 #include <cstdint>
-#include <string>
+#include <span>
 
 #include "Configuration.hpp"
 #include "Focuser.hpp"
@@ -17,6 +18,125 @@ UartThread::UartThread(Focuser &focuser, UartHandler &uart_handler)
 		 config::threads::serial_priority, "uart"),
 	  m_parser(focuser), m_uart_handler(uart_handler)
 {
+	focuser.set_notification_callback(&UartThread::on_notification, this);
+	focuser.set_baud_rate_callback(&UartThread::on_baud_rate, this);
+}
+
+void UartThread::on_notification(moonlite::Notification notification, std::uint16_t position,
+				 void *user_data)
+{
+	auto *self = static_cast<UartThread *>(user_data);
+	char frame[moonlite::kNotificationLength];
+	const std::size_t length = moonlite::writeNotification(frame, notification, position);
+
+	/* Runs on the focuser thread: never wait for the line or for a reply
+	 * being queued, and go out between responses rather than inside one.
+	 * Frames that cannot go out now, or would overtake ones already
+	 * queued, are left to run().
+	 */
+	if (self->m_pending_notifications.empty() &&
+	    self->m_uart_handler.try_write(frame, length, K_NO_WAIT))
+	{
+		LOG_INF("TX %.*s", static_cast<int>(length), frame);
+		return;
+	}
+
+	if ((self->m_pending_notifications.capacity() - self->m_pending_notifications.size()) <
+	    length)
+	{
+		LOG_WRN("Notification queue full, dropped %c", static_cast<char>(notification));
+		return;
+	}
+	(void)self->m_pending_notifications.push(reinterpret_cast<const std::uint8_t *>(frame),
+						 length);
+	self->m_uart_handler.wake_reader();
+	LOG_DBG("TX busy, queued notification %c", static_cast<char>(notification));
+}
+
+void UartThread::send_pending_notifications()
+{
+	char frame[moonlite::kNotificationLength];
+
+	/* Skipped only once written, so on_notification() cannot slip a newer
+	 * frame ahead of the one on its way out.
+	 */
+	while (m_pending_notifications.peek(reinterpret_cast<std::uint8_t *>(frame),
+					    sizeof(frame)) == sizeof(frame))
+	{
+		m_uart_handler.write(frame, sizeof(frame));
+		m_pending_notifications.skip(sizeof(frame));
+		LOG_INF("TX %.*s", static_cast<int>(sizeof(frame)), frame);
+	}
+}
+
+bool UartThread::on_baud_rate(std::uint32_t baud, void *user_data)
+{
+	if (!IS_ENABLED(CONFIG_UART_USE_RUNTIME_CONFIGURE))
+	{
+		return false;
+	}
+
+	/* Runs on this thread from within the parser; run() switches once the
+	 * reply has been queued. The rate is tried first: once 01# is out the
+	 * client switches, so a rate the driver refuses later strands it until
+	 * the fallback. The client waits for the reply, so the line is quiet
+	 * once earlier replies have left.
+	 */
+	auto *self = static_cast<UartThread *>(user_data);
+	if (!self->m_uart_handler.flush_tx(K_MSEC(kBaudSwitchFlushMs)))
+	{
+		LOG_WRN("TX not drained before trying %u baud", baud);
+		return false;
+	}
+	if (!self->m_uart_handler.supports_baud_rate(baud))
+	{
+		return false;
+	}
+
+	self->m_requested_baud = baud;
+	return true;
+}
+
+void UartThread::switch_baud_rate(std::size_t unread)
+{
+	const std::uint32_t baud = m_requested_baud;
+	const std::uint32_t previous = m_uart_handler.baud_rate();
+	m_requested_baud = 0U;
+	if (baud == previous)
+	{
+		return;
+	}
+
+	if (!m_uart_handler.flush_tx(K_MSEC(kBaudSwitchFlushMs)))
+	{
+		LOG_WRN("TX not drained before switching to %u baud", baud);
+	}
+	/* The rest of the current chunk and whatever is still in the RX ring
+	 * was sent at the old rate.
+	 */
+	const std::size_t pre_switch = unread + m_uart_handler.rx_pending();
+	if (m_uart_handler.set_baud_rate(baud) != 0)
+	{
+		return;
+	}
+
+	m_fallback_baud = previous;
+	m_pre_switch_bytes = pre_switch;
+	m_fallback_deadline = sys_timepoint_calc(K_MSEC(CONFIG_APP_UART_BAUD_FALLBACK_MS));
+}
+
+void UartThread::confirm_baud_rate()
+{
+	LOG_INF("Host confirmed %u baud", m_uart_handler.baud_rate());
+	m_fallback_baud = 0U;
+}
+
+void UartThread::fall_back_baud_rate()
+{
+	LOG_WRN("No frame at %u baud, falling back to %u", m_uart_handler.baud_rate(),
+		m_fallback_baud);
+	(void)m_uart_handler.set_baud_rate(m_fallback_baud);
+	m_fallback_baud = 0U;
 }
 
 void UartThread::start()
@@ -29,69 +149,89 @@ void UartThread::start()
 
 void UartThread::run()
 {
-	std::string response;
-	std::string frame_log;
-	bool frame_overflow = false;
+	char rx[kRxChunkSize + 1];
+	char tx[kTxBatchSize + 1];
+	std::uint32_t reported_drops = 0U;
 
 	while (true)
 	{
-		std::uint8_t byte;
-		if (!m_uart_handler.read_byte(byte, K_FOREVER))
+		const k_timeout_t timeout = (m_fallback_baud != 0U)
+						    ? sys_timepoint_timeout(m_fallback_deadline)
+						    : K_FOREVER;
+		const std::size_t received = m_uart_handler.read(reinterpret_cast<std::uint8_t *>(rx),
+								 kRxChunkSize, timeout);
+
+		const std::uint32_t dropped = m_uart_handler.rx_dropped();
+		if (dropped != reported_drops)
 		{
-			continue;
+			LOG_WRN("UART RX ring full, dropped %u byte(s)", dropped - reported_drops);
+			reported_drops = dropped;
 		}
 
-		const char c = static_cast<char>(byte);
+		/* Checked even when bytes arrive: noise at the wrong rate must not
+		 * keep the link on it.
+		 */
+		if ((m_fallback_baud != 0U) && sys_timepoint_expired(m_fallback_deadline))
+		{
+			fall_back_baud_rate();
+		}
+
+		/* Also how a wake_reader() from on_notification() is served. */
+		send_pending_notifications();
 
-		if (c == ':')
+		if (received == 0U)
 		{
-			frame_log.clear();
-			frame_overflow = false;
-			frame_log.push_back(c);
+			continue;
 		}
-		else if (!frame_log.empty())
+
+		rx[received] = '\0';
+		LOG_DBG("RX %s", rx);
+
+		std::size_t offset = 0U;
+		while (offset < received)
 		{
-			if (frame_log.size() < kMaxLoggedFrameLen)
+			/* Bytes sent before a switch are fed on their own so that
+			 * their frames are not mistaken for the host following it.
+			 */
+			const bool pre_switch = (m_pre_switch_bytes > 0U);
+			std::size_t length = received - offset;
+			if (pre_switch && (length > m_pre_switch_bytes))
 			{
-				frame_log.push_back(c);
+				length = m_pre_switch_bytes;
 			}
-			else
+
+			const auto result = m_parser.feed(&rx[offset], length,
+							  std::span<char>(tx, kTxBatchSize));
+			offset += result.consumed;
+			if (pre_switch)
 			{
-				frame_overflow = true;
+				m_pre_switch_bytes -= result.consumed;
 			}
-		}
 
-		if (m_parser.feed(c, response))
-		{
-			if (!frame_log.empty())
+			if (result.responseLength > 0U)
 			{
-				if (frame_overflow)
-				{
-					LOG_INF("RX %s... (truncated)", frame_log.c_str());
-				}
-				else
-				{
-					LOG_INF("RX %s", frame_log.c_str());
-				}
+				tx[result.responseLength] = '\0';
+				LOG_INF("TX %s", tx);
+				m_uart_handler.write(tx, result.responseLength);
+				send_pending_notifications();
 			}
-			else
+			else if (result.frames > 0U)
 			{
-				LOG_INF("RX <unframed>");
+				LOG_DBG("%u command(s) produced no response",
+					static_cast<unsigned int>(result.frames));
 			}
 
-			if (!response.empty())
+			/* Only a known command sent at the new rate shows the host
+			 * followed the switch; noise can still complete a frame.
+			 */
+			if ((m_fallback_baud != 0U) && !pre_switch && (result.recognized > 0U))
 			{
-				LOG_INF("TX %s", response.c_str());
-				m_uart_handler.write(response);
+				confirm_baud_rate();
 			}
-			else
+			if (m_requested_baud != 0U)
 			{
-				LOG_DBG("command produced no response");
+				switch_baud_rate(received - offset);
 			}
-
-			frame_log.clear();
-			frame_overflow = false;
-			response.clear();
 		}
 	}
 }
@@ -1,12 +1,24 @@
 #pragma once
 
+#include <zephyr/kernel.h>
+
 #include <Moonlite.hpp>
 
+#include <cstddef>
+#include <cstdint>
+
+#include "SpscRing.hpp"
 #include "Thread.hpp"
 
 class Focuser;
 class UartHandler;
 
+#ifdef CONFIG_APP_STATIC_PARSER
+using FocuserParser = moonlite::BasicParser<Focuser>;
+#else
+using FocuserParser = moonlite::Parser;
+#endif
+
 class UartThread : public Thread {
 public:
 	UartThread(Focuser &focuser, UartHandler &uart_handler);
@@ -15,9 +27,40 @@ public:
 
 private:
 	void run() override;
+	static void on_notification(moonlite::Notification notification, std::uint16_t position,
+				    void *user_data);
+	static bool on_baud_rate(std::uint32_t baud, void *user_data);
+	void send_pending_notifications();
+	void switch_baud_rate(std::size_t unread);
+	void confirm_baud_rate();
+	void fall_back_baud_rate();
+
+	/* Bytes drained from the RX ring per wakeup. */
+	static constexpr std::size_t kRxChunkSize = 32U;
+	/* Shortest Moonlite frame, e.g. :GP#. */
+	static constexpr std::size_t kMinFrameLength = 4U;
+	/* Responses are batched up to this size; the parser pauses when it fills.
+	 * Sized so that a whole RX chunk of query frames goes out as one write.
+	 */
+	static constexpr std::size_t kTxBatchSize =
+		(kRxChunkSize / kMinFrameLength) * moonlite::kMaxResponseLength;
+	/* Bytes of notification frames waiting for this thread; holds 9 frames. */
+	static constexpr std::size_t kNotificationQueueSize = 64U;
 
-	static constexpr std::size_t kMaxLoggedFrameLen = 80U;
+	/* Longest wait for an XB reply to leave the line before switching. */
+	static constexpr int32_t kBaudSwitchFlushMs = 100;
 
-	moonlite::Parser m_parser;
+	FocuserParser m_parser;
 	UartHandler &m_uart_handler;
+	/* Rate accepted by XB, applied once the reply is sent; 0 when none. */
+	std::uint32_t m_requested_baud{0U};
+	/* Rate to return to unless a frame arrives by the deadline; 0 when settled. */
+	std::uint32_t m_fallback_baud{0U};
+	k_timepoint_t m_fallback_deadline{};
+	/* Bytes that arrived before the last switch and are still to be parsed;
+	 * their frames do not confirm the new rate.
+	 */
+	std::size_t m_pre_switch_bytes{0U};
+	/* Whole notification frames pushed by the focuser thread, sent by this one. */
+	SpscRing<kNotificationQueueSize> m_pending_notifications;
 };
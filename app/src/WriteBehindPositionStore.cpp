@@ -0,0 +1,111 @@
+#include "WriteBehindPositionStore.hpp"
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(position_store, CONFIG_APP_LOG_LEVEL);
+
+WriteBehindPositionStore::WriteBehindPositionStore(PositionStore &backing, k_work_q &queue,
+						   int32_t idle_delay_ms)
+	: m_backing(backing), m_queue(queue), m_idle_delay_ms(idle_delay_ms)
+{
+	k_work_init_delayable(&m_item.work, &WriteBehindPositionStore::work_handler);
+	m_item.owner = this;
+}
+
+WriteBehindPositionStore::~WriteBehindPositionStore()
+{
+	/* Pending data is dropped; call flush() first to keep it. */
+	k_work_sync sync;
+	(void)k_work_cancel_delayable_sync(&m_item.work, &sync);
+}
+
+bool WriteBehindPositionStore::load(PersistentState &state_out)
+{
+	{
+		k_spinlock_key_t key = k_spin_lock(&m_lock);
+		const bool pending = m_pending;
+		const PersistentState state = m_pending_state;
+		k_spin_unlock(&m_lock, key);
+
+		if (pending)
+		{
+			state_out = state;
+			return true;
+		}
+	}
+
+	return m_backing.load(state_out);
+}
+
+void WriteBehindPositionStore::save(const PersistentState &state)
+{
+	k_spinlock_key_t key = k_spin_lock(&m_lock);
+	m_pending_state = state;
+	m_pending = true;
+	const bool moving = m_motion_active;
+	k_spin_unlock(&m_lock, key);
+
+	if (!moving)
+	{
+		/* Restart the idle timer; only the latest state gets written. */
+		(void)k_work_reschedule_for_queue(&m_queue, &m_item.work, K_MSEC(m_idle_delay_ms));
+	}
+}
+
+void WriteBehindPositionStore::flush()
+{
+	(void)k_work_reschedule_for_queue(&m_queue, &m_item.work, K_NO_WAIT);
+
+	k_work_sync sync;
+	(void)k_work_flush_delayable(&m_item.work, &sync);
+}
+
+void WriteBehindPositionStore::set_motion_active(bool active)
+{
+	k_spinlock_key_t key = k_spin_lock(&m_lock);
+	m_motion_active = active;
+	const bool pending = m_pending;
+	k_spin_unlock(&m_lock, key);
+
+	if (active)
+	{
+		/* Keep flash quiet while moving; the idle timer restarts afterwards. */
+		(void)k_work_cancel_delayable(&m_item.work);
+	}
+	else if (pending)
+	{
+		(void)k_work_reschedule_for_queue(&m_queue, &m_item.work, K_MSEC(m_idle_delay_ms));
+	}
+}
+
+uint32_t WriteBehindPositionStore::backing_writes() const
+{
+	return m_backing_writes;
+}
+
+void WriteBehindPositionStore::work_handler(k_work *work)
+{
+	k_work_delayable *delayable = k_work_delayable_from_work(work);
+	WorkItem *item = CONTAINER_OF(delayable, WorkItem, work);
+	item->owner->write_pending();
+}
+
+void WriteBehindPositionStore::write_pending()
+{
+	k_spinlock_key_t key = k_spin_lock(&m_lock);
+	const bool pending = m_pending;
+	const PersistentState state = m_pending_state;
+	m_pending = false;
+	k_spin_unlock(&m_lock, key);
+
+	if (!pending)
+	{
+		return;
+	}
+
+	m_backing.save(state);
+	++m_backing_writes;
+	LOG_DBG("Persisted position 0x%04x (%u), speed %u, half step %u", state.position,
+		state.position, state.speed_multiplier, state.half_step ? 1U : 0U);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#include <cstdint>
+
+#include "PositionStore.hpp"
+
+/* Decorator that moves writes of another PositionStore onto a work queue.
+ * save() only records the latest state; the backing store is written
+ * once motion has been idle for idle_delay_ms, so callers never wait for
+ * flash erase/program cycles and bursts of saves collapse into one write.
+ * Until then the state lives in RAM only: the firmware does not call
+ * flush(), so a power loss inside the idle window loses the latest save.
+ */
+class WriteBehindPositionStore final : public PositionStore
+{
+public:
+	WriteBehindPositionStore(PositionStore &backing, k_work_q &queue, int32_t idle_delay_ms);
+	~WriteBehindPositionStore() override;
+
+	WriteBehindPositionStore(const WriteBehindPositionStore &) = delete;
+	WriteBehindPositionStore &operator=(const WriteBehindPositionStore &) = delete;
+
+	bool load(PersistentState &state_out) override;
+	void save(const PersistentState &state) override;
+	/* Blocks until the pending state is written; not for use on the queue itself. */
+	void flush() override;
+	void set_motion_active(bool active) override;
+
+	/* Number of writes issued to the backing store. */
+	uint32_t backing_writes() const;
+
+private:
+	struct WorkItem
+	{
+		k_work_delayable work;
+		WriteBehindPositionStore *owner;
+	};
+
+	static void work_handler(k_work *work);
+	void write_pending();
+
+	PositionStore &m_backing;
+	k_work_q &m_queue;
+	const int32_t m_idle_delay_ms;
+	WorkItem m_item{};
+
+	k_spinlock m_lock{};
+	bool m_pending{false};
+	bool m_motion_active{false};
+	PersistentState m_pending_state{};
+	uint32_t m_backing_writes{0U};
+};
@@ -56,6 +56,18 @@ int ZephyrFocuserStepper::move_to(int32_t target)
 	return stepper_move_to(m_stepper, target);
 }
 
+int ZephyrFocuserStepper::run(Direction direction)
+{
+	if (m_stepper == nullptr)
+	{
+		return -ENODEV;
+	}
+
+	return stepper_run(m_stepper, (direction == Direction::positive)
+					      ? STEPPER_DIRECTION_POSITIVE
+					      : STEPPER_DIRECTION_NEGATIVE);
+}
+
 int ZephyrFocuserStepper::is_moving(bool &moving)
 {
 	if (m_stepper == nullptr)
@@ -95,3 +107,37 @@ int ZephyrFocuserStepper::enable_driver(bool enable)
 
 	return enable ? stepper_drv_enable(m_stepper_drv) : stepper_drv_disable(m_stepper_drv);
 }
+
+int ZephyrFocuserStepper::set_event_callback(EventCallback callback, void *user_data)
+{
+	if (m_stepper == nullptr)
+	{
+		return -ENODEV;
+	}
+
+	m_event_callback = callback;
+	m_event_user_data = user_data;
+	return stepper_set_event_callback(m_stepper, &ZephyrFocuserStepper::on_stepper_event, this);
+}
+
+void ZephyrFocuserStepper::on_stepper_event(const struct device *, const enum stepper_event event,
+					    void *user_data)
+{
+	auto *self = static_cast<ZephyrFocuserStepper *>(user_data);
+	if ((self == nullptr) || (self->m_event_callback == nullptr))
+	{
+		return;
+	}
+
+	Event mapped = Event::other;
+	if (event == STEPPER_EVENT_STEPS_COMPLETED)
+	{
+		mapped = Event::steps_completed;
+	}
+	else if (event == STEPPER_EVENT_STOPPED)
+	{
+		mapped = Event::stopped;
+	}
+
+	self->m_event_callback(mapped, self->m_event_user_data);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <zephyr/drivers/stepper.h>
+
 #include "FocuserStepper.hpp"
 
 struct device;
@@ -14,12 +16,19 @@ public:
 	int set_reference_position(int32_t position) override;
 	int set_microstep_interval(uint64_t interval_ns) override;
 	int move_to(int32_t target) override;
+	int run(Direction direction) override;
 	int is_moving(bool &moving) override;
 	int stop() override;
 	int get_actual_position(int32_t &position) override;
 	int enable_driver(bool enable) override;
+	int set_event_callback(EventCallback callback, void *user_data) override;
 
 private:
+	static void on_stepper_event(const struct device *dev, const enum stepper_event event,
+				     void *user_data);
+
 	const struct device *m_stepper;
 	const struct device *m_stepper_drv;
+	EventCallback m_event_callback{nullptr};
+	void *m_event_user_data{nullptr};
 };
@@ -12,11 +12,17 @@
 #include <errno.h>
 
 #include "Configuration.hpp"
+#ifdef CONFIG_APP_POSITION_BACKEND_SETTINGS
+#include "SettingsPositionStore.hpp"
+#else
 #include "EepromPositionStore.hpp"
+#endif
 #include "Focuser.hpp"
 #include "FocuserThread.hpp"
+#include "RetainedPositionStore.hpp"
 #include "UartHandler.hpp"
 #include "UartThread.hpp"
+#include "WriteBehindPositionStore.hpp"
 #include "ZephyrStepper.hpp"
 
 LOG_MODULE_REGISTER(focuser, CONFIG_APP_LOG_LEVEL);
@@ -24,13 +30,36 @@ LOG_MODULE_REGISTER(focuser, CONFIG_APP_LOG_LEVEL);
 namespace
 {
 
-	EepromPositionStore g_position_store;
+#ifdef CONFIG_APP_POSITION_BACKEND_SETTINGS
+	SettingsPositionStore g_backing_store;
+#else
+	EepromPositionStore g_backing_store;
+#endif
+	k_work_q g_persistence_queue;
+	WriteBehindPositionStore g_position_store(g_backing_store, g_persistence_queue,
+						  CONFIG_APP_POSITION_SAVE_IDLE_MS);
+#ifdef CONFIG_APP_POSITION_RETAINED_RAM
+	__noinit RetainedPositionStore::Block g_retained_block;
+	RetainedPositionStore g_retained_store(g_position_store, g_retained_block);
+	PositionStore &g_focuser_store = g_retained_store;
+#else
+	PositionStore &g_focuser_store = g_position_store;
+#endif
 	ZephyrFocuserStepper g_stepper_adapter(config::devices::stepper, config::devices::stepper_drv);
-	Focuser g_focuser(g_stepper_adapter, &g_position_store, config::version);
+	Focuser g_focuser(g_stepper_adapter, &g_focuser_store, config::version);
 	FocuserThread g_focuser_thread(g_focuser);
 	UartHandler g_uart_handler(config::devices::uart);
 	UartThread g_uart_thread(g_focuser, g_uart_handler);
 
+	const char *position_source()
+	{
+#ifdef CONFIG_APP_POSITION_RETAINED_RAM
+		return RetainedPositionStore::source_name(g_retained_store.last_load_source());
+#else
+		return "storage";
+#endif
+	}
+
 } // namespace
 
 int main(void)
@@ -50,18 +79,27 @@ int main(void)
 		return ret;
 	}
 
+	k_work_queue_start(&g_persistence_queue, config::threads::persistence_stack,
+			   K_THREAD_STACK_SIZEOF(config::threads::persistence_stack),
+			   config::threads::persistence_priority, nullptr);
+	k_thread_name_set(k_work_queue_thread_get(&g_persistence_queue), "persistence");
+
+	const uint32_t restore_start = k_cycle_get_32();
 	ret = g_focuser.initialise();
 	if (ret != 0)
 	{
 		LOG_ERR("Failed to initialize focuser (%d)", ret);
 		return ret;
 	}
+	const uint32_t restore_us = k_cyc_to_us_ceil32(k_cycle_get_32() - restore_start);
 
 	g_focuser_thread.start();
 
 	g_uart_thread.start();
 
-	LOG_INF("Moonlite focuser ready: UART 9600 8N1");
+	LOG_INF("Moonlite focuser ready after %u ms: UART %u 8N1",
+		static_cast<unsigned int>(k_uptime_get_32()), g_uart_handler.baud_rate());
+	LOG_INF("Focuser initialised in %u us, position source: %s", restore_us, position_source());
 
 	return 0;
 }
@@ -1,306 +1,278 @@
 #include "Moonlite.hpp"
 
+#include <algorithm>
+
 namespace moonlite
 {
 
-int expectedPayloadLength(CommandType cmd)
+namespace
+{
+
+/*
+ * Opcode lookup: a perfect hash over the two opcode bytes, found at compile
+ * time, maps each opcode to a slot holding its index in kCommandTable.
+ * Decoding is one multiply, one table load and a key compare.
+ */
+constexpr std::size_t kOpcodeSlots = 64;
+constexpr uint8_t kEmptySlot = 0xFF;
+
+static_assert((kOpcodeSlots & (kOpcodeSlots - 1)) == 0, "slot count must be a power of two");
+static_assert(kCommandCount < kEmptySlot, "command index must fit a slot byte");
+
+constexpr std::size_t opcodeSlot(uint16_t key, uint32_t seed)
+{
+  return ((static_cast<uint32_t>(key) * seed) >> 16) & (kOpcodeSlots - 1);
+}
+
+constexpr bool isPerfectSeed(uint32_t seed)
 {
-  switch (cmd)
+  bool used[kOpcodeSlots]{};
+  for (const CommandSpec &spec : kCommandTable)
   {
-  case CommandType::set_current_position:
-  case CommandType::set_new_position:
-    return 4; // PPPP
-  case CommandType::set_speed:
-    return 2; // SS
-  case CommandType::get_current_position:
-  case CommandType::get_new_position:
-  case CommandType::go_to_new_position:
-  case CommandType::check_if_half_step:
-  case CommandType::set_full_step:
-  case CommandType::set_half_step:
-  case CommandType::check_if_moving:
-  case CommandType::get_firmware_version:
-  case CommandType::get_speed:
-  case CommandType::get_temperature:
-  case CommandType::get_temperature_coefficient:
-  case CommandType::stop:
-  case CommandType::unrecognized:
-  default:
-    return 0;
+    const std::size_t slot = opcodeSlot(spec.opcode, seed);
+    if (used[slot])
+    {
+      return false;
+    }
+    used[slot] = true;
   }
+  return true;
 }
 
-CommandType strToCommandType(const char *buffer)
+constexpr uint32_t findPerfectSeed()
 {
-  if (buffer == nullptr)
+  for (uint32_t seed = 1; seed < 0x10000; ++seed)
   {
-    return CommandType::unrecognized;
+    if (isPerfectSeed(seed))
+    {
+      return seed;
+    }
   }
+  return 0;
+}
+
+constexpr uint32_t kOpcodeSeed = findPerfectSeed();
 
-  const uint16_t opcode = (static_cast<uint16_t>(static_cast<uint8_t>(buffer[0])) << 8) |
-                          static_cast<uint8_t>(buffer[1]);
+struct OpcodeSlots
+{
+  uint8_t index[kOpcodeSlots];
+};
 
-  switch (opcode)
+constexpr OpcodeSlots buildOpcodeSlots()
+{
+  OpcodeSlots slots{};
+  for (uint8_t &entry : slots.index)
   {
-  case ('F' << 8) | 'Q':
-    return CommandType::stop;
-  case ('G' << 8) | 'P':
-    return CommandType::get_current_position;
-  case ('S' << 8) | 'P':
-    return CommandType::set_current_position;
-  case ('G' << 8) | 'N':
-    return CommandType::get_new_position;
-  case ('S' << 8) | 'N':
-    return CommandType::set_new_position;
-  case ('F' << 8) | 'G':
-    return CommandType::go_to_new_position;
-  case ('G' << 8) | 'H':
-    return CommandType::check_if_half_step;
-  case ('S' << 8) | 'F':
-    return CommandType::set_full_step;
-  case ('S' << 8) | 'H':
-    return CommandType::set_half_step;
-  case ('G' << 8) | 'I':
-    return CommandType::check_if_moving;
-  case ('G' << 8) | 'V':
-    return CommandType::get_firmware_version;
-  case ('G' << 8) | 'D':
-    return CommandType::get_speed;
-  case ('S' << 8) | 'D':
-    return CommandType::set_speed;
-  case ('G' << 8) | 'T':
-    return CommandType::get_temperature;
-  case ('G' << 8) | 'C':
-    return CommandType::get_temperature_coefficient;
-  default:
-    break;
+    entry = kEmptySlot;
   }
-
-  return CommandType::unrecognized;
+  for (std::size_t i = 0; i < kCommandCount; ++i)
+  {
+    slots.index[opcodeSlot(kCommandTable[i].opcode, kOpcodeSeed)] = static_cast<uint8_t>(i);
+  }
+  return slots;
 }
 
-std::string hex2(uint8_t v)
-{
-  char buf[3];
-  static const char *digits = "0123456789ABCDEF";
-  buf[0] = digits[(v >> 4) & 0x0F];
-  buf[1] = digits[v & 0x0F];
-  buf[2] = '\0';
-  return std::string(buf);
-}
+constexpr OpcodeSlots kOpcodeSlotTable = buildOpcodeSlots();
 
-std::string hex4(uint16_t v)
+constexpr CommandType lookupOpcode(uint16_t key)
 {
-  char buf[5];
-  static const char *digits = "0123456789ABCDEF";
-  buf[0] = digits[(v >> 12) & 0x0F];
-  buf[1] = digits[(v >> 8) & 0x0F];
-  buf[2] = digits[(v >> 4) & 0x0F];
-  buf[3] = digits[v & 0x0F];
-  buf[4] = '\0';
-  return std::string(buf);
+  const uint8_t index = kOpcodeSlotTable.index[opcodeSlot(key, kOpcodeSeed)];
+  if ((index == kEmptySlot) || (kCommandTable[index].opcode != key))
+  {
+    return CommandType::unrecognized;
+  }
+  return kCommandTable[index].type;
 }
 
-uint16_t parseHex4(const std::string &s)
+/* Compile-time checks on the command table. */
+
+constexpr bool tableFollowsEnumOrder()
 {
-  unsigned v = 0;
-  for (char c : s)
+  for (std::size_t i = 0; i < kCommandCount; ++i)
   {
-    v <<= 4;
-    if (c >= '0' && c <= '9')
-    {
-      v |= (c - '0');
-    }
-    else if (c >= 'A' && c <= 'F')
+    if (static_cast<std::size_t>(kCommandTable[i].type) != i)
     {
-      v |= (c - 'A' + 10);
+      return false;
     }
-    else if (c >= 'a' && c <= 'f')
+  }
+  return true;
+}
+
+constexpr bool opcodesAreUnique()
+{
+  for (std::size_t i = 0; i < kCommandCount; ++i)
+  {
+    for (std::size_t j = i + 1; j < kCommandCount; ++j)
     {
-      v |= (c - 'a' + 10);
+      if (kCommandTable[i].opcode == kCommandTable[j].opcode)
+      {
+        return false;
+      }
     }
   }
-  return static_cast<uint16_t>(v & 0xFFFF);
+  return true;
 }
 
-uint8_t parseHex2(const std::string &s)
+constexpr bool everyOpcodeRoundTrips()
 {
-  unsigned v = 0;
-  for (char c : s)
+  for (const CommandSpec &spec : kCommandTable)
   {
-    v <<= 4;
-    if (c >= '0' && c <= '9')
+    if ((lookupOpcode(spec.opcode) != spec.type) || (spec.invoke == nullptr))
     {
-      v |= (c - '0');
+      return false;
     }
-    else if (c >= 'A' && c <= 'F')
+  }
+  return true;
+}
+
+constexpr bool settersHaveNoReply()
+{
+  for (const CommandSpec &spec : kCommandTable)
+  {
+    /* XB is acknowledged so the host knows when to follow the switch; XT
+     * is a query whose payload selects the point.
+     */
+    if ((spec.type == CommandType::set_baud_rate) ||
+        (spec.type == CommandType::get_program_point_time))
     {
-      v |= (c - 'A' + 10);
+      continue;
     }
-    else if (c >= 'a' && c <= 'f')
+    if ((spec.payloadLength > 0) && (spec.response != ResponseShape::none))
     {
-      v |= (c - 'a' + 10);
+      return false;
     }
   }
-  return static_cast<uint8_t>(v & 0xFF);
+  return true;
 }
 
-Parser::Parser(Handler &handler) : _handler(&handler)
+static_assert(kCommandCount == static_cast<std::size_t>(CommandType::unrecognized),
+              "kCommandTable must have exactly one entry per CommandType");
+static_assert(tableFollowsEnumOrder(), "kCommandTable entries must follow CommandType order");
+static_assert(opcodesAreUnique(), "duplicate opcode in kCommandTable");
+static_assert(kOpcodeSeed != 0, "no perfect hash for the opcode set; grow kOpcodeSlots");
+static_assert(everyOpcodeRoundTrips(), "opcode lookup must resolve every table entry");
+static_assert(settersHaveNoReply(), "commands with a payload must not produce a reply");
+static_assert(lookupOpcode(opcodeKey("GP")) == CommandType::get_current_position);
+static_assert(lookupOpcode(opcodeKey("XX")) == CommandType::unrecognized);
+static_assert(lookupOpcode(opcodeKey("gp")) == CommandType::unrecognized);
+static_assert(kMaxPayloadLength == 4, "SP/SN carry the longest payload");
+
+} // namespace
+
+int expectedPayloadLength(CommandType cmd)
 {
-  reset();
+  const CommandSpec *spec = commandSpec(cmd);
+  return (spec != nullptr) ? spec->payloadLength : 0;
 }
 
-bool Parser::feed(char c, std::string &outResponse)
+CommandType strToCommandType(const char *buffer)
 {
-  outResponse.clear();
-
-  if (c == ':')
+  if (buffer == nullptr)
   {
-    reset();
-    _state = State::ReadingOpcode;
-    return false;
+    return CommandType::unrecognized;
   }
 
-  if (_state == State::Idle)
-  {
-    return false;
-  }
+  return lookupOpcode(opcodeKey(buffer[0], buffer[1]));
+}
 
-  if (_state == State::ReadingOpcode)
-  {
-    _buf.push_back(c);
-    if (_buf.size() == 2)
-    {
-      _cmd = strToCommandType(_buf.c_str());
-      _buf.clear();
-      _state = State::ReadingPayload;
-    }
-    return false;
-  }
+namespace
+{
+constexpr char kHexDigits[] = "0123456789ABCDEF";
+} // namespace
 
-  if (_state == State::ReadingPayload)
+uint32_t parseHex(std::string_view s)
+{
+  uint32_t v = 0;
+  for (char c : s)
   {
-    if (c != '#')
+    v <<= 4;
+    if (c >= '0' && c <= '9')
     {
-      _buf.push_back(c);
-      if (_buf.size() > 16)
-      {
-        reset();
-        return false;
-      }
-      return false;
+      v |= (c - '0');
     }
-
-    const int expected = expectedPayloadLength(_cmd);
-    if (_cmd == CommandType::unrecognized)
+    else if (c >= 'A' && c <= 'F')
     {
-      reset();
-      return true;
+      v |= (c - 'A' + 10);
     }
-
-    if (expected >= 0)
+    else if (c >= 'a' && c <= 'f')
     {
-      if (static_cast<int>(_buf.size()) != expected)
-      {
-        reset();
-        return true;
-      }
-
-      if (expected > 0)
-      {
-        for (char ch : _buf)
-        {
-          if (!isHexChar(ch))
-          {
-            reset();
-            return true;
-          }
-        }
-      }
+      v |= (c - 'a' + 10);
     }
+  }
+  return v;
+}
 
-    std::string respPayload;
-    if (_handler)
-    {
-      respPayload = handleCommand(_cmd, _buf);
-    }
+std::size_t writeHex2(char *out, uint8_t v)
+{
+  out[0] = kHexDigits[(v >> 4) & 0x0F];
+  out[1] = kHexDigits[v & 0x0F];
+  return 2;
+}
 
-    const bool requires_terminator = (_cmd != CommandType::get_firmware_version);
+std::size_t writeHex4(char *out, uint16_t v)
+{
+  out[0] = kHexDigits[(v >> 12) & 0x0F];
+  out[1] = kHexDigits[(v >> 8) & 0x0F];
+  out[2] = kHexDigits[(v >> 4) & 0x0F];
+  out[3] = kHexDigits[v & 0x0F];
+  return 4;
+}
 
-    reset();
+std::size_t writeHex8(char *out, uint32_t v)
+{
+  writeHex4(out, static_cast<uint16_t>(v >> 16));
+  writeHex4(out + 4, static_cast<uint16_t>(v & 0xFFFF));
+  return 8;
+}
 
-    if (!respPayload.empty())
-    {
-      outResponse = respPayload;
-      if (requires_terminator)
-      {
-        outResponse.push_back('#');
-      }
-    }
-    return true;
-  }
+std::size_t writeStatus(char *out, const Status &status)
+{
+  std::size_t length = writeHex4(out, status.position);
+  length += writeHex4(out + length, status.target);
+  length += writeHex4(out + length, status.temperature);
+  length += writeHex2(out + length, status.flags);
+  return length;
+}
+
+std::size_t writeNotification(char *out, Notification kind, uint16_t position)
+{
+  out[0] = '!';
+  out[1] = static_cast<char>(kind);
+  writeHex4(out + 2, position);
+  out[kNotificationLength - 1] = '#';
+  return kNotificationLength;
+}
 
-  return false;
+std::size_t writeText(char *out, std::string_view text)
+{
+  const std::size_t length =
+      (text.size() < kMaxFirmwareVersionLength) ? text.size() : kMaxFirmwareVersionLength;
+  std::copy_n(text.data(), length, out);
+  return length;
 }
 
-void Parser::reset()
+std::string hex2(uint8_t v)
 {
-  _buf.clear();
-  _cmd = CommandType::unrecognized;
-  _state = State::Idle;
+  char buf[2];
+  return std::string(buf, writeHex2(buf, v));
 }
 
-bool Parser::isHexChar(char c)
+std::string hex4(uint16_t v)
 {
-  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+  char buf[4];
+  return std::string(buf, writeHex4(buf, v));
 }
 
-std::string Parser::handleCommand(CommandType cmd, const std::string &payload)
+uint16_t parseHex4(std::string_view s)
 {
-  switch (cmd)
-  {
-  case CommandType::stop:
-    _handler->stop();
-    return std::string();
-  case CommandType::get_current_position:
-    return hex4(_handler->getCurrentPosition());
-  case CommandType::set_current_position:
-    _handler->setCurrentPosition(parseHex4(payload));
-    return std::string();
-  case CommandType::get_new_position:
-    return hex4(_handler->getNewPosition());
-  case CommandType::set_new_position:
-    _handler->setNewPosition(parseHex4(payload));
-    return std::string();
-  case CommandType::go_to_new_position:
-    _handler->goToNewPosition();
-    return std::string();
-  case CommandType::check_if_half_step:
-    return _handler->isHalfStep() ? std::string("FF") : std::string("00");
-  case CommandType::set_full_step:
-    _handler->setHalfStep(false);
-    return std::string();
-  case CommandType::set_half_step:
-    _handler->setHalfStep(true);
-    return std::string();
-  case CommandType::check_if_moving:
-    return _handler->isMoving() ? std::string("01") : std::string("00");
-  case CommandType::get_firmware_version:
-    return _handler->getFirmwareVersion();
-  case CommandType::get_speed:
-    return hex2(_handler->getSpeed());
-  case CommandType::set_speed:
-    _handler->setSpeed(parseHex2(payload));
-    return std::string();
-  case CommandType::get_temperature:
-    return hex4(_handler->getTemperature());
-  case CommandType::get_temperature_coefficient:
-    return hex2(_handler->getTemperatureCoefficientRaw());
-  default:
-    break;
-  }
+  return static_cast<uint16_t>(parseHex(s) & 0xFFFF);
+}
 
-  return std::string();
+uint8_t parseHex2(std::string_view s)
+{
+  return static_cast<uint8_t>(parseHex(s) & 0xFF);
 }
 
+template class BasicParser<Handler>;
+
 } // namespace moonlite
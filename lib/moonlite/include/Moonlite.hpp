@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace moonlite
 {
@@ -135,10 +139,169 @@ namespace moonlite
      */
     get_temperature_coefficient,
 
+    /**
+     * `XS` (extension)
+     *   Payload: none
+     *   Response: `PPPPNNNNTTTTSS#`
+     *   Action: report the current position (as `GP`), the target (as `GN`),
+     *   the temperature (as `GT`) and a status byte (see kStatusMoving and
+     *   friends) in one frame, all taken from the same instant.
+     */
+    get_status,
+
+    /**
+     * `XN` (extension)
+     *   Payload: `EE` (`01` to enable, `00` to disable)
+     *   Response: none
+     *   Action: opt in to unsolicited notification frames (see Notification).
+     *   Notifications are off after reset, so clients that never send `XN`
+     *   see the plain protocol.
+     */
+    set_notifications,
+
+    /**
+     * `XB` (extension)
+     *   Payload: `RR`, an index into kBaudRates
+     *   Response: `01#` when accepted, `00#` otherwise
+     *   Action: switch the serial link to a faster rate. The reply is sent at
+     *   the old rate and the controller switches once it has left the line;
+     *   if no frame arrives at the new rate it falls back to the old one.
+     */
+    set_baud_rate,
+
+    /**
+     * `XG` (extension)
+     *   Payload: `PPPP`
+     *   Response: none (motion begins)
+     *   Action: stage `PPPP` as the new target and start moving, as `SN`
+     *   followed by `FG` would, in one frame.
+     */
+    go_to_position,
+
+    /**
+     * `XR` (extension)
+     *   Payload: `DDDD`, a signed 16-bit two's-complement step count
+     *   Response: none (motion begins)
+     *   Action: move by `DDDD` steps from the current position (or from the
+     *   target of the move in progress), clamped to 0..FFFF.
+     */
+    move_relative,
+
+    /**
+     * `XE` (extension)
+     *   Payload: none
+     *   Response: `MMMMMMMM#`
+     *   Action: report the estimated time until the current move ends, in
+     *   milliseconds. `00000000#` when idle, or when the handler cannot
+     *   estimate it (see Handler::getRemainingMoveTime()).
+     */
+    get_remaining_time,
+
+    /**
+     * `XC` (extension)
+     *   Payload: none
+     *   Response: none
+     *   Action: empty the motion program being uploaded and reset its dwell
+     *   to zero. A program that is already running is not affected.
+     */
+    clear_program,
+
+    /**
+     * `XW` (extension)
+     *   Payload: `DDDD`, milliseconds
+     *   Response: none
+     *   Action: set the dwell after each point appended from now on; the
+     *   focuser rests this long at the point before moving to the next one.
+     */
+    set_program_dwell,
+
+    /**
+     * `XA` (extension)
+     *   Payload: `PPPP`
+     *   Response: none
+     *   Action: append the absolute target `PPPP` to the motion program,
+     *   with the current `XW` dwell. Ignored once the program is full.
+     */
+    add_program_point,
+
+    /**
+     * `XP` (extension)
+     *   Payload: none
+     *   Response: none (motion begins)
+     *   Action: run the uploaded program. Each point is reported with a
+     *   Notification::point_reached frame and the end of the program with
+     *   Notification::move_completed. `FQ` or any other move ends it.
+     */
+    run_program,
+
+    /**
+     * `XT` (extension)
+     *   Payload: `II`, a point index
+     *   Response: `MMMMMMMM#`
+     *   Action: report how many milliseconds the last run took to reach point
+     *   `II` from the previous one (or from the start), 0 if it was not reached.
+     */
+    get_program_point_time,
+
+    /**
+     * `XJ` (extension)
+     *   Payload: `RRRR`, a signed 16-bit two's-complement rate in steps/s
+     *   Response: none
+     *   Action: run continuously in the direction of `RRRR` until the rate
+     *   is 0 or the handler's keepalive expires; repeat the frame to keep
+     *   jogging. Each frame may change the rate. `FQ` stops at once.
+     */
+    jog,
+
     /** Unrecognised command string. */
     unrecognized
   };
 
+  /** Longest firmware version string reported by `GV`; longer strings are truncated. */
+  inline constexpr std::size_t kMaxFirmwareVersionLength = 16;
+
+  /** Bits of the `XS` status byte. */
+  inline constexpr uint8_t kStatusMoving = 0x01;   ///< Same as `GI` reporting `01#`.
+  inline constexpr uint8_t kStatusHalfStep = 0x02; ///< Same as `GH` reporting `FF#`.
+  inline constexpr uint8_t kStatusProgram = 0x04;  ///< A motion program started by `XP` is running.
+  inline constexpr uint8_t kStatusFault = 0x80;    ///< The controller failed to carry out the last move.
+
+  /** Everything reported by `XS`. */
+  struct Status
+  {
+    uint16_t position;
+    uint16_t target;
+    uint16_t temperature;
+    uint8_t flags;
+  };
+
+  /**
+   * Unsolicited frames sent once enabled with `XN`. Each is `!<kind>PPPP#`,
+   * where PPPP is the position the focuser came to rest at. The leading '!'
+   * never starts a reply, so a client can tell them apart from responses.
+   */
+  enum class Notification : char
+  {
+    move_completed = 'C', ///< The move reached its target.
+    move_cancelled = 'Q', ///< The move was stopped by `FQ`.
+    move_failed = 'F',    ///< The controller could not carry out the move.
+    point_reached = 'P'   ///< A motion program reached a point; its dwell starts.
+  };
+
+  /** Rates selectable with `XB`, by index. Index 0 is the stock Moonlite rate. */
+  inline constexpr uint32_t kBaudRates[] = {9600, 19200, 38400, 57600, 115200, 230400, 460800};
+  inline constexpr std::size_t kBaudRateCount = sizeof(kBaudRates) / sizeof(kBaudRates[0]);
+
+  /** Length of a notification frame, including the leading '!' and trailing '#'. */
+  inline constexpr std::size_t kNotificationLength = 1 + 1 + 4 + 1;
+
+  /** `base + delta`, saturated to the 0..65535 position range. */
+  constexpr uint16_t clampedPosition(uint16_t base, int32_t delta)
+  {
+    const int32_t target = static_cast<int32_t>(base) + delta;
+    return static_cast<uint16_t>((target < 0) ? 0 : ((target > 0xFFFF) ? 0xFFFF : target));
+  }
+
   /** Expected request payload length (in hex chars) for each command. */
   int expectedPayloadLength(CommandType cmd);
 
@@ -192,8 +355,11 @@ namespace moonlite
     /** Whether the focuser is currently moving (GI). */
     virtual bool isMoving() = 0;
 
-    /** Provide firmware version string (GV). */
-    virtual std::string getFirmwareVersion() = 0;
+    /**
+     * Provide firmware version string (GV). The returned view must stay valid
+     * until the next call into the handler.
+     */
+    virtual std::string_view getFirmwareVersion() = 0;
 
     /** Return the current speed multiplier byte (GD). */
     virtual uint8_t getSpeed() = 0;
@@ -206,15 +372,251 @@ namespace moonlite
 
     /** Return the raw temperature coefficient byte (GC). */
     virtual uint8_t getTemperatureCoefficientRaw() = 0;
+
+    /**
+     * Report position, target, temperature and status flags at once (XS).
+     * The default composes the individual getters; override it when they
+     * can be served from one consistent copy of the state.
+     */
+    virtual Status getStatus()
+    {
+      Status status{getCurrentPosition(), getNewPosition(), getTemperature(), 0};
+      status.flags = static_cast<uint8_t>((isMoving() ? kStatusMoving : 0) |
+                                          (isHalfStep() ? kStatusHalfStep : 0));
+      return status;
+    }
+
+    /**
+     * Enable or disable unsolicited notification frames (XN). Handlers that
+     * cannot send them keep the default, which ignores the request.
+     */
+    virtual void setNotifications(bool) {}
+
+    /**
+     * Accept or refuse a switch of the serial link to `baud` (XB). The switch
+     * itself must wait until the reply has been transmitted. The default
+     * refuses, keeping the link at its current rate.
+     */
+    virtual bool setBaudRate(uint32_t) { return false; }
+
+    /** Stage `position` and start the move at once (XG). */
+    virtual void goToPosition(uint16_t position)
+    {
+      setNewPosition(position);
+      goToNewPosition();
+    }
+
+    /**
+     * Move by `delta` steps, clamped to the 16-bit range (XR). The default
+     * counts from the reported position; handlers that know the target of a
+     * move in progress should count from there so nudges accumulate.
+     */
+    virtual void moveRelative(int16_t delta)
+    {
+      goToPosition(clampedPosition(getCurrentPosition(), delta));
+    }
+
+    /**
+     * Estimated milliseconds until the current move ends (XE). Handlers that
+     * cannot estimate keep the default, 0, and clients fall back to polling GI.
+     */
+    virtual uint32_t getRemainingMoveTime() { return 0; }
+
+    /**
+     * Motion program upload and execution (XC, XW, XA, XP). Handlers without
+     * a program queue keep the defaults, which ignore the requests.
+     */
+    virtual void clearProgram() {}
+    virtual void setProgramDwell(uint16_t) {}
+    virtual void addProgramPoint(uint16_t) {}
+    virtual void runProgram() {}
+
+    /** Milliseconds the last program run took to reach point `index` (XT). */
+    virtual uint32_t getProgramPointTime(uint8_t) { return 0; }
+
+    /**
+     * Run at `rate` steps/s, negative inward, until 0 or the keepalive
+     * expires (XJ). Handlers without a jog mode ignore it.
+     */
+    virtual void jog(int16_t) {}
   };
 
   /** Format a byte/word as uppercase hexadecimal strings. */
   std::string hex2(uint8_t v);
   std::string hex4(uint16_t v);
 
+  /**
+   * Allocation-free variants of hex2()/hex4(), plus an eight-digit form.
+   * Write exactly two/four/eight characters to `out` (no NUL terminator) and
+   * return the number written.
+   */
+  std::size_t writeHex2(char *out, uint8_t v);
+  std::size_t writeHex4(char *out, uint16_t v);
+  std::size_t writeHex8(char *out, uint32_t v);
+
+  /** Write `status` as the fourteen hex digits of an `XS` reply; returns the number written. */
+  std::size_t writeStatus(char *out, const Status &status);
+
+  /** Write a complete notification frame to `out`; returns kNotificationLength. */
+  std::size_t writeNotification(char *out, Notification kind, uint16_t position);
+
+  /** Copy `text` to `out`, clipped to kMaxFirmwareVersionLength; returns the length copied. */
+  std::size_t writeText(char *out, std::string_view text);
+
   /** Parse hexadecimal payloads emitted by the Moonlite protocol. */
-  uint16_t parseHex4(const std::string &s);
-  uint8_t parseHex2(const std::string &s);
+  uint16_t parseHex4(std::string_view s);
+  uint8_t parseHex2(std::string_view s);
+
+  /** Parse a hexadecimal payload of up to eight digits. */
+  uint32_t parseHex(std::string_view s);
+
+  /** Shape of a command's reply; fixes its width and whether '#' is appended. */
+  enum class ResponseShape : uint8_t
+  {
+    none, ///< No reply.
+    hex2, ///< Two hex digits followed by '#'.
+    hex4, ///< Four hex digits followed by '#'.
+    hex8, ///< Eight hex digits followed by '#'.
+    text,  ///< Up to kMaxFirmwareVersionLength characters, sent verbatim.
+    status ///< Fourteen hex digits (`XS`) followed by '#'.
+  };
+
+  /** Number of characters a reply of `shape` occupies, including any terminator. */
+  constexpr std::size_t responseWidth(ResponseShape shape)
+  {
+    switch (shape)
+    {
+    case ResponseShape::hex2:
+      return 2 + 1;
+    case ResponseShape::hex4:
+      return 4 + 1;
+    case ResponseShape::hex8:
+      return 8 + 1;
+    case ResponseShape::text:
+      return kMaxFirmwareVersionLength;
+    case ResponseShape::status:
+      return 14 + 1;
+    case ResponseShape::none:
+    default:
+      return 0;
+    }
+  }
+
+  /** Pack a two-character opcode into the 16-bit key used for lookups. */
+  constexpr uint16_t opcodeKey(char first, char second)
+  {
+    return static_cast<uint16_t>((static_cast<uint16_t>(static_cast<uint8_t>(first)) << 8) |
+                                 static_cast<uint8_t>(second));
+  }
+
+  constexpr uint16_t opcodeKey(const char (&name)[3])
+  {
+    return opcodeKey(name[0], name[1]);
+  }
+
+  /** Value returned by command bindings that produce no reply. */
+  inline constexpr std::size_t kNoResponse = 0;
+
+  /**
+   * Compile-time description of one Moonlite command bound to `HandlerT`.
+   *
+   * `invoke` receives the payload already parsed from hex (0 when the command
+   * takes none), writes the reply without its terminator to `response` and
+   * returns the number of characters written.
+   */
+  template <typename HandlerT>
+  struct BasicCommandSpec
+  {
+    uint16_t opcode;
+    CommandType type;
+    uint8_t payloadLength;
+    ResponseShape response;
+    std::size_t (*invoke)(HandlerT &handler, uint32_t argument, char *response);
+  };
+
+  using CommandSpec = BasicCommandSpec<Handler>;
+
+  /**
+   * The Moonlite command set, one entry per opcode in `CommandType` order,
+   * with handler calls bound statically to `HandlerT`. Adding a command means
+   * adding its enumerator and one line here; the opcode lookup and buffer
+   * sizes are derived from this table at compile time.
+   */
+  template <typename HandlerT>
+  inline constexpr BasicCommandSpec<HandlerT> kBasicCommandTable[] = {
+      // clang-format off
+      {opcodeKey("FQ"), CommandType::stop,                        0, ResponseShape::none, [](HandlerT &h, uint32_t, char *) { h.stop(); return kNoResponse; }},
+      {opcodeKey("GP"), CommandType::get_current_position,        0, ResponseShape::hex4, [](HandlerT &h, uint32_t, char *out) { return writeHex4(out, h.getCurrentPosition()); }},
+      {opcodeKey("SP"), CommandType::set_current_position,        4, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.setCurrentPosition(static_cast<uint16_t>(arg)); return kNoResponse; }},
+      {opcodeKey("GN"), CommandType::get_new_position,            0, ResponseShape::hex4, [](HandlerT &h, uint32_t, char *out) { return writeHex4(out, h.getNewPosition()); }},
+      {opcodeKey("SN"), CommandType::set_new_position,            4, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.setNewPosition(static_cast<uint16_t>(arg)); return kNoResponse; }},
+      {opcodeKey("FG"), CommandType::go_to_new_position,          0, ResponseShape::none, [](HandlerT &h, uint32_t, char *) { h.goToNewPosition(); return kNoResponse; }},
+      {opcodeKey("GH"), CommandType::check_if_half_step,          0, ResponseShape::hex2, [](HandlerT &h, uint32_t, char *out) { return writeHex2(out, h.isHalfStep() ? 0xFF : 0x00); }},
+      {opcodeKey("SF"), CommandType::set_full_step,               0, ResponseShape::none, [](HandlerT &h, uint32_t, char *) { h.setHalfStep(false); return kNoResponse; }},
+      {opcodeKey("SH"), CommandType::set_half_step,               0, ResponseShape::none, [](HandlerT &h, uint32_t, char *) { h.setHalfStep(true); return kNoResponse; }},
+      {opcodeKey("GI"), CommandType::check_if_moving,             0, ResponseShape::hex2, [](HandlerT &h, uint32_t, char *out) { return writeHex2(out, h.isMoving() ? 0x01 : 0x00); }},
+      {opcodeKey("GV"), CommandType::get_firmware_version,        0, ResponseShape::text, [](HandlerT &h, uint32_t, char *out) { return writeText(out, h.getFirmwareVersion()); }},
+      {opcodeKey("GD"), CommandType::get_speed,                   0, ResponseShape::hex2, [](HandlerT &h, uint32_t, char *out) { return writeHex2(out, h.getSpeed()); }},
+      {opcodeKey("SD"), CommandType::set_speed,                   2, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.setSpeed(static_cast<uint8_t>(arg)); return kNoResponse; }},
+      {opcodeKey("GT"), CommandType::get_temperature,             0, ResponseShape::hex4, [](HandlerT &h, uint32_t, char *out) { return writeHex4(out, h.getTemperature()); }},
+      {opcodeKey("GC"), CommandType::get_temperature_coefficient, 0, ResponseShape::hex2, [](HandlerT &h, uint32_t, char *out) { return writeHex2(out, h.getTemperatureCoefficientRaw()); }},
+      {opcodeKey("XS"), CommandType::get_status,                  0, ResponseShape::status, [](HandlerT &h, uint32_t, char *out) { return writeStatus(out, h.getStatus()); }},
+      {opcodeKey("XN"), CommandType::set_notifications,           2, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.setNotifications(arg != 0); return kNoResponse; }},
+      {opcodeKey("XB"), CommandType::set_baud_rate,               2, ResponseShape::hex2, [](HandlerT &h, uint32_t arg, char *out) { return writeHex2(out, ((arg < kBaudRateCount) && h.setBaudRate(kBaudRates[arg])) ? 0x01 : 0x00); }},
+      {opcodeKey("XG"), CommandType::go_to_position,              4, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.goToPosition(static_cast<uint16_t>(arg)); return kNoResponse; }},
+      {opcodeKey("XR"), CommandType::move_relative,               4, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.moveRelative(static_cast<int16_t>(static_cast<uint16_t>(arg))); return kNoResponse; }},
+      {opcodeKey("XE"), CommandType::get_remaining_time,          0, ResponseShape::hex8, [](HandlerT &h, uint32_t, char *out) { return writeHex8(out, h.getRemainingMoveTime()); }},
+      {opcodeKey("XC"), CommandType::clear_program,               0, ResponseShape::none, [](HandlerT &h, uint32_t, char *) { h.clearProgram(); return kNoResponse; }},
+      {opcodeKey("XW"), CommandType::set_program_dwell,           4, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.setProgramDwell(static_cast<uint16_t>(arg)); return kNoResponse; }},
+      {opcodeKey("XA"), CommandType::add_program_point,           4, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.addProgramPoint(static_cast<uint16_t>(arg)); return kNoResponse; }},
+      {opcodeKey("XP"), CommandType::run_program,                 0, ResponseShape::none, [](HandlerT &h, uint32_t, char *) { h.runProgram(); return kNoResponse; }},
+      {opcodeKey("XT"), CommandType::get_program_point_time,      2, ResponseShape::hex8, [](HandlerT &h, uint32_t arg, char *out) { return writeHex8(out, h.getProgramPointTime(static_cast<uint8_t>(arg))); }},
+      {opcodeKey("XJ"), CommandType::jog,                         4, ResponseShape::none, [](HandlerT &h, uint32_t arg, char *) { h.jog(static_cast<int16_t>(static_cast<uint16_t>(arg))); return kNoResponse; }},
+      // clang-format on
+  };
+
+  /** The command table dispatching through the virtual `Handler` interface. */
+  inline constexpr auto &kCommandTable = kBasicCommandTable<Handler>;
+
+  /** Number of recognised commands. */
+  inline constexpr std::size_t kCommandCount = sizeof(kCommandTable) / sizeof(kCommandTable[0]);
+
+  namespace detail
+  {
+    constexpr std::size_t maxPayloadLength()
+    {
+      std::size_t longest = 0;
+      for (const CommandSpec &spec : kCommandTable)
+      {
+        longest = (spec.payloadLength > longest) ? spec.payloadLength : longest;
+      }
+      return longest;
+    }
+
+    constexpr std::size_t maxResponseLength()
+    {
+      std::size_t longest = 0;
+      for (const CommandSpec &spec : kCommandTable)
+      {
+        const std::size_t width = responseWidth(spec.response);
+        longest = (width > longest) ? width : longest;
+      }
+      return longest;
+    }
+  } // namespace detail
+
+  /** Longest request payload (in hex chars) accepted by any command. */
+  inline constexpr std::size_t kMaxPayloadLength = detail::maxPayloadLength();
+
+  /** Buffer size that fits any response emitted by the parser, including the trailing '#'. */
+  inline constexpr std::size_t kMaxResponseLength = detail::maxResponseLength();
+
+  /** Table entry for `cmd`, or nullptr for `CommandType::unrecognized`. */
+  constexpr const CommandSpec *commandSpec(CommandType cmd)
+  {
+    const auto index = static_cast<std::size_t>(cmd);
+    return (index < kCommandCount) ? &kCommandTable[index] : nullptr;
+  }
 
   /**
    * Streaming Moonlite protocol parser.
@@ -223,16 +625,61 @@ namespace moonlite
    *   - Construct with a handler implementation.
    *   - Feed incoming bytes via feed().
    *   - When a full frame is parsed, feed() returns true and (optionally)
-   *     populates the response string, which already includes the trailing '#'.
+   *     populates the response, which already includes the trailing '#'.
+   *
+   * The parser keeps the frame in a fixed inline buffer sized for the longest
+   * legal payload, so the span-based feed() never touches the heap. Payloads
+   * that overflow the buffer are discarded and the frame completes without a
+   * response once its terminator arrives.
+   *
+   * `HandlerT` is the handler type the commands are dispatched to. `Parser`
+   * binds the virtual `Handler` interface, which suits tests and mocks.
+   * Binding a concrete (ideally `final`) handler type instead lets the
+   * compiler call and inline its methods directly.
    */
-  class Parser
+  template <typename HandlerT>
+  class BasicParser
   {
   public:
-    explicit Parser(Handler &handler);
+    explicit BasicParser(HandlerT &handler);
 
-    /** Feed a single byte of input; returns true when a frame completes. */
+    /**
+     * Feed a single byte of input; returns true when a frame completes.
+     *
+     * The response is written to `response` and its length stored in
+     * `responseLength` (0 when the command has no reply). Responses longer than
+     * `response` are truncated; a span of kMaxResponseLength never truncates.
+     */
+    bool feed(char c, std::span<char> response, std::size_t &responseLength);
+
+    /** Convenience overload of feed() that returns the response as a string. */
     bool feed(char c, std::string &outResponse);
 
+    /** Outcome of a bulk feed() call. */
+    struct FeedResult
+    {
+      /** Number of input bytes consumed. */
+      std::size_t consumed;
+      /** Number of frames completed (with or without a response). */
+      std::size_t frames;
+      /** Number of completed frames that were a known command with a valid payload. */
+      std::size_t recognized;
+      /** Total length of the responses written back to back into the span. */
+      std::size_t responseLength;
+    };
+
+    /**
+     * Feed a burst of input bytes.
+     *
+     * Responses of all completed frames are written back to back into
+     * `response`. Consumption stops early, before a frame terminator, when the
+     * remaining space could not hold another kMaxResponseLength response; the
+     * caller should drain `response` and feed the rest of the burst again. The
+     * first frame of a call is always processed, truncating as in the
+     * single-byte overload if `response` is too small.
+     */
+    FeedResult feed(const char *data, std::size_t length, std::span<char> response);
+
     /** Reset the parser state machine (used on framing errors). */
     void reset();
 
@@ -246,12 +693,200 @@ namespace moonlite
 
     static bool isHexChar(char c);
 
-    std::string handleCommand(CommandType cmd, const std::string &payload);
+    /** Advance the state machine by one byte that does not terminate a frame. */
+    void consume(char c);
+
+    /** True if the buffered frame is a known command with a valid payload. */
+    bool isValidFrame() const;
 
-    Handler *_handler;
+    /** Validate and dispatch the buffered frame; returns the response length. */
+    std::size_t completeFrame(std::span<char> response);
+
+    static_assert(kMaxPayloadLength >= 2, "frame buffer also holds the two opcode characters");
+
+    HandlerT *_handler;
     State _state{State::Idle};
     CommandType _cmd{CommandType::unrecognized};
-    std::string _buf;
+    bool _overflow{false};
+    uint8_t _len{0};
+    char _buf[kMaxPayloadLength]{};
   };
 
+  /** Parser dispatching through the virtual `Handler` interface. */
+  using Parser = BasicParser<Handler>;
+
+  template <typename HandlerT>
+  BasicParser<HandlerT>::BasicParser(HandlerT &handler) : _handler(&handler)
+  {
+    reset();
+  }
+
+  template <typename HandlerT>
+  bool BasicParser<HandlerT>::feed(char c, std::string &outResponse)
+  {
+    char response[kMaxResponseLength];
+    std::size_t length = 0;
+    const bool completed = feed(c, response, length);
+    outResponse.assign(response, length);
+    return completed;
+  }
+
+  template <typename HandlerT>
+  bool BasicParser<HandlerT>::feed(char c, std::span<char> response, std::size_t &responseLength)
+  {
+    if ((c == '#') && (_state == State::ReadingPayload))
+    {
+      responseLength = completeFrame(response);
+      return true;
+    }
+
+    responseLength = 0;
+    consume(c);
+    return false;
+  }
+
+  template <typename HandlerT>
+  typename BasicParser<HandlerT>::FeedResult
+  BasicParser<HandlerT>::feed(const char *data, std::size_t length, std::span<char> response)
+  {
+    FeedResult result{0, 0, 0, 0};
+
+    for (; result.consumed < length; ++result.consumed)
+    {
+      const char c = data[result.consumed];
+      if ((c != '#') || (_state != State::ReadingPayload))
+      {
+        consume(c);
+        continue;
+      }
+
+      const std::size_t room = response.size() - result.responseLength;
+      if ((result.frames > 0) && (room < kMaxResponseLength))
+      {
+        break;
+      }
+
+      if (isValidFrame())
+      {
+        ++result.recognized;
+      }
+      result.responseLength += completeFrame(response.subspan(result.responseLength));
+      ++result.frames;
+    }
+
+    return result;
+  }
+
+  template <typename HandlerT>
+  void BasicParser<HandlerT>::consume(char c)
+  {
+    if (c == ':')
+    {
+      reset();
+      _state = State::ReadingOpcode;
+      return;
+    }
+
+    if (_state == State::ReadingOpcode)
+    {
+      _buf[_len++] = c;
+      if (_len == 2)
+      {
+        _cmd = strToCommandType(_buf);
+        _len = 0;
+        _state = State::ReadingPayload;
+      }
+    }
+    else if (_state == State::ReadingPayload)
+    {
+      if (_len < kMaxPayloadLength)
+      {
+        _buf[_len++] = c;
+      }
+      else
+      {
+        _overflow = true;
+      }
+    }
+  }
+
+  template <typename HandlerT>
+  bool BasicParser<HandlerT>::isValidFrame() const
+  {
+    const auto index = static_cast<std::size_t>(_cmd);
+    if ((index >= kCommandCount) || _overflow)
+    {
+      return false;
+    }
+
+    if (_len != kBasicCommandTable<HandlerT>[index].payloadLength)
+    {
+      return false;
+    }
+
+    for (uint8_t i = 0; i < _len; ++i)
+    {
+      if (!isHexChar(_buf[i]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template <typename HandlerT>
+  std::size_t BasicParser<HandlerT>::completeFrame(std::span<char> response)
+  {
+    if (!isValidFrame())
+    {
+      reset();
+      return 0;
+    }
+
+    const BasicCommandSpec<HandlerT> &spec =
+        kBasicCommandTable<HandlerT>[static_cast<std::size_t>(_cmd)];
+
+    char payload[kMaxResponseLength];
+    std::size_t payloadLength = 0;
+    if (_handler)
+    {
+      payloadLength = spec.invoke(*_handler, parseHex(std::string_view(_buf, _len)), payload);
+    }
+
+    const bool requires_terminator = (spec.response != ResponseShape::text);
+
+    reset();
+
+    if (payloadLength == 0)
+    {
+      return 0;
+    }
+
+    std::size_t length = (payloadLength < response.size()) ? payloadLength : response.size();
+    std::copy_n(payload, length, response.begin());
+    if (requires_terminator && (length < response.size()))
+    {
+      response[length++] = '#';
+    }
+    return length;
+  }
+
+  template <typename HandlerT>
+  void BasicParser<HandlerT>::reset()
+  {
+    _len = 0;
+    _overflow = false;
+    _cmd = CommandType::unrecognized;
+    _state = State::Idle;
+  }
+
+  template <typename HandlerT>
+  bool BasicParser<HandlerT>::isHexChar(char c)
+  {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+  }
+
+  /* The virtual-dispatch parser is compiled once, in Moonlite.cpp. */
+  extern template class BasicParser<Handler>;
+
 } // namespace moonlite
@@ -0,0 +1,308 @@
+#include <zephyr/drivers/eeprom/eeprom_fake.h>
+#include <zephyr/ztest.h>
+
+#include <errno.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "EepromPositionStore.hpp"
+
+namespace
+{
+
+constexpr size_t kEepromSize = 1024U;
+/* Erase granularity of the flash the simulated EEPROM is backed by. */
+constexpr size_t kPageSize = 256U;
+constexpr size_t kSlotCount = kEepromSize / sizeof(EepromPositionStore::JournalRecord);
+constexpr uint32_t kEnduranceSaves = 100000U;
+
+/* Flash-backed EEPROM model: programming may only clear bits, so any write
+ * that needs to set a bit costs an erase of every page it touches.
+ */
+struct SimulatedFlash
+{
+	uint8_t data[kEepromSize];
+	uint32_t page_erases;
+	uint32_t writes;
+};
+
+SimulatedFlash g_flash;
+
+int flash_write(const struct device *, off_t offset, const void *data, size_t len)
+{
+	if ((offset < 0) || (static_cast<size_t>(offset) + len > kEepromSize))
+	{
+		return -EINVAL;
+	}
+
+	const auto *bytes = static_cast<const uint8_t *>(data);
+	const size_t start = static_cast<size_t>(offset);
+	for (size_t page = start / kPageSize; page <= (start + len - 1U) / kPageSize; ++page)
+	{
+		const size_t first = (page * kPageSize > start) ? page * kPageSize : start;
+		const size_t last = ((page + 1U) * kPageSize < start + len) ? (page + 1U) * kPageSize
+									    : start + len;
+		for (size_t i = first; i < last; ++i)
+		{
+			if ((bytes[i - start] & ~g_flash.data[i]) != 0U)
+			{
+				++g_flash.page_erases;
+				break;
+			}
+		}
+	}
+
+	std::memcpy(&g_flash.data[start], bytes, len);
+	++g_flash.writes;
+	return 0;
+}
+
+int flash_read(const struct device *, off_t offset, void *data, size_t len)
+{
+	if ((offset < 0) || (static_cast<size_t>(offset) + len > kEepromSize))
+	{
+		return -EINVAL;
+	}
+	std::memcpy(data, &g_flash.data[static_cast<size_t>(offset)], len);
+	return 0;
+}
+
+void eeprom_journal_before(void *)
+{
+	std::memset(g_flash.data, 0xFF, sizeof(g_flash.data));
+	g_flash.page_erases = 0U;
+	g_flash.writes = 0U;
+
+	RESET_FAKE(fake_eeprom_read);
+	RESET_FAKE(fake_eeprom_write);
+	RESET_FAKE(fake_eeprom_size);
+	fake_eeprom_size_fake.custom_fake = [](const struct device *) -> size_t {
+		return kEepromSize;
+	};
+	fake_eeprom_write_fake.custom_fake = flash_write;
+	fake_eeprom_read_fake.custom_fake = flash_read;
+}
+
+uint16_t position_for(uint32_t save)
+{
+	/* Consecutive saves always differ, so none are skipped as duplicates. */
+	return static_cast<uint16_t>(save * 37U);
+}
+
+PersistentState state_for(uint32_t save)
+{
+	return PersistentState{.position = position_for(save)};
+}
+
+void write_record(size_t slot, const EepromPositionStore::JournalRecord &record)
+{
+	std::memcpy(&g_flash.data[slot * sizeof(record)], &record, sizeof(record));
+}
+
+EepromPositionStore::JournalRecord read_record(size_t slot)
+{
+	EepromPositionStore::JournalRecord record{};
+	std::memcpy(&record, &g_flash.data[slot * sizeof(record)], sizeof(record));
+	return record;
+}
+
+} // namespace
+
+ZTEST(eeprom_journal, test_saves_append_across_the_eeprom)
+{
+	EepromPositionStore store;
+	for (uint32_t i = 0; i < kSlotCount; ++i)
+	{
+		store.save(state_for(i));
+	}
+
+	for (size_t slot = 0; slot < kSlotCount; ++slot)
+	{
+		const EepromPositionStore::JournalRecord record = read_record(slot);
+		PersistentState state{};
+		zassert_equal(record.sequence, slot, "slot %u holds the wrong record",
+			static_cast<unsigned int>(slot));
+		zassert_equal(record.version, persistent_state::kVersion, "record version");
+		zassert_true(persistent_state::decode(record.payload, record.length, state),
+			"slot %u payload", static_cast<unsigned int>(slot));
+		zassert_equal(state.position, position_for(slot), "slot %u position",
+			static_cast<unsigned int>(slot));
+	}
+	zassert_equal(store.compactions(), 0U, "a log with free slots is not compacted");
+}
+
+ZTEST(eeprom_journal, test_newest_record_found_after_wrapping)
+{
+	for (const uint32_t saves : {1U, 2U, 63U, 128U, 129U, 300U, 1000U})
+	{
+		eeprom_journal_before(nullptr);
+		{
+			EepromPositionStore store;
+			for (uint32_t i = 0; i < saves; ++i)
+			{
+				store.save(state_for(i));
+			}
+		}
+
+		EepromPositionStore rebooted;
+		PersistentState loaded{};
+		const unsigned int reads_before = fake_eeprom_read_fake.call_count;
+		zassert_true(rebooted.load(loaded), "load after %u saves", saves);
+		zassert_equal(loaded.position, position_for(saves - 1U), "newest of %u saves", saves);
+		zassert_true((fake_eeprom_read_fake.call_count - reads_before) <= 12U,
+			"boot scan should binary search, not read every slot");
+
+		/* The next save continues the sequence instead of restarting it. */
+		rebooted.save(PersistentState{.position = 0x5A5AU});
+		EepromPositionStore again;
+		zassert_true(again.load(loaded), "load after resumed save");
+		zassert_equal(loaded.position, 0x5A5AU, "resumed save is the newest record");
+	}
+}
+
+ZTEST(eeprom_journal, test_torn_record_falls_back_to_previous)
+{
+	EepromPositionStore store;
+	store.save(PersistentState{.position = 0x0100});
+	store.save(PersistentState{.position = 0x0200});
+	store.save(PersistentState{.position = 0x0300});
+
+	/* Power lost half way through the third record. */
+	g_flash.data[2U * sizeof(EepromPositionStore::JournalRecord) + 4U] ^= 0x5AU;
+
+	EepromPositionStore rebooted;
+	PersistentState loaded{};
+	zassert_true(rebooted.load(loaded), "older records survive a torn write");
+	zassert_equal(loaded.position, 0x0200, "previous record restored");
+}
+
+ZTEST(eeprom_journal, test_torn_first_slot_during_compaction)
+{
+	EepromPositionStore store;
+	for (uint32_t i = 0; i < kSlotCount; ++i)
+	{
+		store.save(state_for(i));
+	}
+
+	/* Compaction interrupted after the erase, before slot 0 was rewritten. */
+	std::memset(g_flash.data, 0xFF, kEepromSize - sizeof(EepromPositionStore::JournalRecord));
+
+	EepromPositionStore rebooted;
+	PersistentState loaded{};
+	zassert_true(rebooted.load(loaded), "last slot keeps the newest record");
+	zassert_equal(loaded.position, position_for(kSlotCount - 1U), "newest position restored");
+}
+
+ZTEST(eeprom_journal, test_legacy_record_is_migrated)
+{
+	const EepromPositionStore::LegacyRecord legacy{
+		.magic = 0x464F4350U,
+		.position = 0x1357U,
+		.checksum = static_cast<uint16_t>(0x464FU ^ 0x4350U ^ 0x1357U),
+	};
+	std::memcpy(g_flash.data, &legacy, sizeof(legacy));
+
+	EepromPositionStore store;
+	PersistentState loaded{};
+	zassert_true(store.load(loaded), "legacy record should load");
+	zassert_equal(loaded.position, 0x1357U, "legacy position");
+
+	store.save(PersistentState{.position = 0x2468U});
+	EepromPositionStore rebooted;
+	zassert_true(rebooted.load(loaded), "journal record after migration");
+	zassert_equal(loaded.position, 0x2468U, "migrated store writes journal records");
+}
+
+ZTEST(eeprom_journal, test_settings_round_trip)
+{
+	const PersistentState saved{
+		.position = 0x7531U,
+		.speed_multiplier = 16U,
+		.half_step = true,
+		.temperature_coeff_times2 = -7,
+	};
+	EepromPositionStore store;
+	store.save(saved);
+
+	EepromPositionStore rebooted;
+	PersistentState loaded{};
+	zassert_true(rebooted.load(loaded), "state should load");
+	zassert_true(loaded == saved, "every field survives the reboot");
+}
+
+ZTEST(eeprom_journal, test_record_length_is_forward_compatible)
+{
+	/* A newer firmware appended fields: the known prefix still decodes. */
+	EepromPositionStore::JournalRecord newer{};
+	newer.sequence = 0U;
+	newer.version = persistent_state::kVersion + 1U;
+	persistent_state::encode(PersistentState{.position = 0x1111U, .speed_multiplier = 4U},
+				 newer.payload);
+	newer.payload[persistent_state::kEncodedSize] = 0xABU;
+	newer.length = persistent_state::kCapacity;
+	newer.crc = EepromPositionStore::journal_crc(newer);
+	write_record(0U, newer);
+
+	/* An older record without the speed byte: the field keeps its default. */
+	EepromPositionStore::JournalRecord older{};
+	older.sequence = 1U;
+	older.version = 0U;
+	persistent_state::encode(PersistentState{.position = 0x2222U, .speed_multiplier = 9U},
+				 older.payload);
+	older.length = 2U;
+	older.crc = EepromPositionStore::journal_crc(older);
+
+	EepromPositionStore store;
+	PersistentState loaded{};
+	zassert_true(store.load(loaded), "newer record should load");
+	zassert_equal(loaded.position, 0x1111U, "known field of a newer record");
+	zassert_equal(loaded.speed_multiplier, 4U, "known field of a newer record");
+
+	write_record(1U, older);
+	EepromPositionStore rebooted;
+	zassert_true(rebooted.load(loaded), "older record should load");
+	zassert_equal(loaded.position, 0x2222U, "position of a shorter record");
+	zassert_equal(loaded.speed_multiplier, 1U, "field missing from a shorter record defaults");
+}
+
+ZTEST(eeprom_journal, test_benchmark_erases_per_100k_saves)
+{
+	/* Baseline: rewrite one record in place, as the single-record layout did. */
+	for (uint32_t i = 0; i < kEnduranceSaves; ++i)
+	{
+		const uint16_t position = position_for(i);
+		const EepromPositionStore::LegacyRecord record{
+			.magic = 0x464F4350U,
+			.position = position,
+			.checksum = static_cast<uint16_t>(0x464FU ^ 0x4350U ^ position),
+		};
+		zassert_ok(flash_write(nullptr, 0, &record, sizeof(record)), "legacy write");
+	}
+	const uint32_t in_place_erases = g_flash.page_erases;
+
+	eeprom_journal_before(nullptr);
+	EepromPositionStore store;
+	for (uint32_t i = 0; i < kEnduranceSaves; ++i)
+	{
+		store.save(state_for(i));
+	}
+	const uint32_t journal_erases = g_flash.page_erases;
+
+	TC_PRINT("%u saves, %u byte EEPROM on %u byte flash pages\n", kEnduranceSaves,
+		 static_cast<unsigned int>(kEepromSize), static_cast<unsigned int>(kPageSize));
+	TC_PRINT("%-10s %12s %12s\n", "layout", "erases", "compactions");
+	TC_PRINT("%-10s %12u %12s\n", "in-place", in_place_erases, "-");
+	TC_PRINT("%-10s %12u %12u\n", "journal", journal_erases, store.compactions());
+
+	EepromPositionStore rebooted;
+	PersistentState loaded{};
+	zassert_true(rebooted.load(loaded), "journal readable after endurance run");
+	zassert_equal(loaded.position, position_for(kEnduranceSaves - 1U), "newest position survives");
+	zassert_equal(store.compactions(), (kEnduranceSaves - 1U) / kSlotCount,
+		"log compacts once per pass over the whole EEPROM");
+	zassert_true((journal_erases * 10U) < in_place_erases,
+		"journal should cut erases by at least an order of magnitude");
+}
+
+ZTEST_SUITE(eeprom_journal, NULL, NULL, eeprom_journal_before, NULL, NULL);
@@ -13,6 +13,7 @@
 
 #include "Focuser.hpp"
 #include "EepromPositionStore.hpp"
+#include "MotionPlanner.hpp"
 #include "ZephyrStepper.hpp"
 
 #ifndef CONFIG_APP_LOG_LEVEL
@@ -33,28 +34,28 @@ constexpr char kFirmwareVersion[] = "twister-test";
 class MockPositionStore final : public PositionStore
 {
 public:
-	bool load(uint16_t &position_out) override
+	bool load(PersistentState &state_out) override
 	{
 		++load_calls;
 		if (!has_value)
 		{
 			return false;
 		}
-		position_out = value;
+		state_out = value;
 		return true;
 	}
 
-	void save(uint16_t position) override
+	void save(const PersistentState &state) override
 	{
 		++save_calls;
-		last_saved = position;
+		last_saved = state;
 	}
 
 	bool has_value{false};
-	uint16_t value{0U};
+	PersistentState value{};
 	unsigned int load_calls{0U};
 	unsigned int save_calls{0U};
-	uint16_t last_saved{0U};
+	PersistentState last_saved{};
 };
 
 void assert_stepper_devices_ready()
@@ -91,6 +92,11 @@ public:
 		return m_impl.move_to(target);
 	}
 
+	int run(Direction direction) override
+	{
+		return m_impl.run(direction);
+	}
+
 	int is_moving(bool &moving) override
 	{
 		return m_impl.is_moving(moving);
@@ -111,11 +117,98 @@ public:
 		return m_impl.enable_driver(enable);
 	}
 
+	int set_event_callback(EventCallback callback, void *user_data) override
+	{
+		return m_impl.set_event_callback(callback, user_data);
+	}
+
 private:
 	FocuserStepper &m_impl;
 	bool m_ready_override;
 };
 
+/* State captured from the fake stepper controller for motion-event tests. */
+stepper_event_callback_t g_event_callback;
+void *g_event_user_data;
+bool g_stepper_moving;
+int32_t g_stepper_target;
+int32_t g_stepper_position;
+
+void install_motion_fakes()
+{
+	g_event_callback = nullptr;
+	g_event_user_data = nullptr;
+	g_stepper_moving = false;
+	g_stepper_target = 0;
+	g_stepper_position = 0;
+
+	fake_stepper_set_event_callback_fake.custom_fake =
+		[](const struct device *, stepper_event_callback_t callback, void *user_data) {
+			g_event_callback = callback;
+			g_event_user_data = user_data;
+			return 0;
+		};
+	fake_stepper_is_moving_fake.custom_fake = [](const struct device *, bool *moving) {
+		*moving = g_stepper_moving;
+		return 0;
+	};
+	fake_stepper_move_to_fake.custom_fake = [](const struct device *, int32_t target) {
+		g_stepper_moving = true;
+		g_stepper_target = target;
+		return 0;
+	};
+	fake_stepper_run_fake.custom_fake = [](const struct device *, enum stepper_direction) {
+		g_stepper_moving = true;
+		return 0;
+	};
+	fake_stepper_get_actual_position_fake.custom_fake = [](const struct device *,
+							       int32_t *position) {
+		*position = g_stepper_position;
+		return 0;
+	};
+}
+
+void raise_stepper_event(enum stepper_event event)
+{
+	zassert_not_null(g_event_callback, "focuser should register a stepper event callback");
+	g_stepper_moving = false;
+	g_stepper_position = g_stepper_target;
+	g_event_callback(k_stepper_controller, event, g_event_user_data);
+}
+
+/* Completes planned segments one by one until the focuser reports idle. */
+void run_to_completion(Focuser &focuser)
+{
+	for (size_t i = 0; (i < 4U * MotionPlan::kMaxSegments) && focuser.isMoving(); ++i)
+	{
+		raise_stepper_event(STEPPER_EVENT_STEPS_COMPLETED);
+		zassert_ok(focuser.run_once(K_NO_WAIT), "segment completion should be handled");
+	}
+	zassert_false(focuser.isMoving(), "motion should finish");
+}
+
+/* Controller calls a request costs beyond its own bookkeeping. */
+unsigned int driver_calls()
+{
+	return fake_stepper_drv_enable_fake.call_count + fake_stepper_drv_disable_fake.call_count +
+	       fake_stepper_set_microstep_interval_fake.call_count +
+	       fake_stepper_move_to_fake.call_count + fake_stepper_run_fake.call_count +
+	       fake_stepper_stop_fake.call_count;
+}
+
+/* Starts a move to target and lets it accelerate through a few segments. */
+void start_accelerated_move(Focuser &focuser, uint16_t target)
+{
+	focuser.setNewPosition(target);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	for (int i = 0; i < 3; ++i)
+	{
+		raise_stepper_event(STEPPER_EVENT_STEPS_COMPLETED);
+		zassert_ok(focuser.run_once(K_NO_WAIT), "segment completion should be handled");
+	}
+}
+
 } // namespace
 
 ZTEST(focuser_app, test_initialise_requires_ready_stepper)
@@ -153,8 +246,8 @@ ZTEST(focuser_app, test_initialise_configures_stepper_when_ready)
 		"reference position should reset to zero");
 	zassert_equal(fake_stepper_set_microstep_interval_fake.call_count, 1U,
 		"step interval should be applied once");
-	zassert_equal(fake_stepper_set_microstep_interval_fake.arg1_val, 500000ULL,
-		"default speed uses 500us interval");
+	zassert_equal(fake_stepper_set_microstep_interval_fake.arg1_val,
+		1000000000ULL / CONFIG_APP_FOCUSER_MAX_SPEED, "default speed cruises at max speed");
 	zassert_equal(fake_stepper_drv_enable_fake.call_count, 0U,
 		"driver should not be enabled during init");
 	zassert_equal(fake_stepper_drv_disable_fake.call_count, 1U,
@@ -167,7 +260,7 @@ ZTEST(focuser_app, test_initialise_restores_position_from_store)
 	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
 	MockPositionStore store;
 	store.has_value = true;
-	store.value = 0x1234;
+	store.value.position = 0x1234;
 	Focuser focuser(stepper, &store, kFirmwareVersion);
 
 	const int ret = focuser.initialise();
@@ -184,6 +277,49 @@ ZTEST(focuser_app, test_initialise_restores_position_from_store)
 		"second reference position should be restored value");
 }
 
+ZTEST(focuser_app, test_initialise_restores_settings_from_store)
+{
+	assert_stepper_devices_ready();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	MockPositionStore store;
+	store.has_value = true;
+	store.value = PersistentState{
+		.position = 0x0800,
+		.speed_multiplier = 8U,
+		.half_step = true,
+		.temperature_coeff_times2 = -3,
+	};
+	Focuser focuser(stepper, &store, kFirmwareVersion);
+
+	zassert_ok(focuser.initialise(), "initialise should succeed");
+
+	/* A reconnecting client sees its settings without resending SD/SH. */
+	zassert_equal(focuser.getCurrentPosition(), 0x0800, "restored position");
+	zassert_equal(focuser.getSpeed(), 8U, "restored speed");
+	zassert_true(focuser.isHalfStep(), "restored half step");
+	zassert_equal(static_cast<int8_t>(focuser.getTemperatureCoefficientRaw()), -3,
+		"restored temperature coefficient");
+	zassert_equal(store.save_calls, 0U, "restore should not persist back");
+}
+
+ZTEST(focuser_app, test_settings_persist_with_position)
+{
+	assert_stepper_devices_ready();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	MockPositionStore store;
+	Focuser focuser(stepper, &store, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setCurrentPosition(0x0400);
+	focuser.setSpeed(4U);
+	focuser.setHalfStep(true);
+
+	zassert_equal(store.save_calls, 3U, "each setting change is saved");
+	zassert_equal(store.last_saved.position, 0x0400, "position kept alongside settings");
+	zassert_equal(store.last_saved.speed_multiplier, 4U, "speed persisted");
+	zassert_true(store.last_saved.half_step, "half step persisted");
+}
+
 ZTEST(focuser_app, test_set_current_position_persists_via_store)
 {
 	assert_stepper_devices_ready();
@@ -195,7 +331,7 @@ ZTEST(focuser_app, test_set_current_position_persists_via_store)
 	focuser.setCurrentPosition(0x1111);
 
 	zassert_equal(store.save_calls, 1U, "setCurrentPosition should persist once");
-	zassert_equal(store.last_saved, 0x1111, "persisted value should match set position");
+	zassert_equal(store.last_saved.position, 0x1111, "persisted value should match set position");
 }
 
 ZTEST(focuser_app, test_set_speed_clamps_to_minimum_and_updates_interval)
@@ -209,18 +345,17 @@ ZTEST(focuser_app, test_set_speed_clamps_to_minimum_and_updates_interval)
 		fake_stepper_set_microstep_interval_fake.call_count;
 
 	focuser.setSpeed(0);
-	zassert_equal(fake_stepper_set_microstep_interval_fake.call_count,
-		initial_microstep_calls + 1U, "setSpeed should update timing once");
-	zassert_equal(fake_stepper_set_microstep_interval_fake.arg1_val, 500000ULL,
-		"speed 0 should clamp to 1x interval");
+	zassert_equal(focuser.snapshot().step_interval_ns,
+		1000000000ULL / CONFIG_APP_FOCUSER_MAX_SPEED, "speed 0 should clamp to 1x interval");
 	zassert_equal(focuser.getSpeed(), 1, "speed should clamp to 1");
 
-	focuser.setSpeed(40);
-	zassert_equal(fake_stepper_set_microstep_interval_fake.call_count,
-		initial_microstep_calls + 2U, "second setSpeed call should reapply interval");
-	zassert_equal(fake_stepper_set_microstep_interval_fake.arg1_val, 10000000ULL,
-		"high multiplier should clamp to 100 sps");
-	zassert_equal(focuser.getSpeed(), 40, "speed multiplier should store requested value");
+	focuser.setSpeed(200);
+	zassert_equal(focuser.snapshot().step_interval_ns,
+		1000000000ULL / CONFIG_APP_FOCUSER_MIN_SPEED,
+		"high multiplier should clamp to the minimum speed");
+	zassert_equal(focuser.getSpeed(), 200, "speed multiplier should store requested value");
+	zassert_equal(fake_stepper_set_microstep_interval_fake.call_count, initial_microstep_calls,
+		"SD must leave the controller to the focuser thread");
 }
 
 ZTEST(focuser_app, test_stop_stops_motion_and_disables_driver)
@@ -253,7 +388,7 @@ ZTEST(focuser_app, test_stop_stops_motion_and_disables_driver)
 	zassert_equal(fake_stepper_drv_disable_fake.call_count, initial_disable_calls + 1U,
 		"stop should disable the driver once");
 	zassert_equal(store.save_calls, 1U, "stop should persist the last known position");
-	zassert_equal(store.last_saved, 0x4321, "stop should persist queried position");
+	zassert_equal(store.last_saved.position, 0x4321, "stop should persist queried position");
 }
 
 ZTEST(focuser_app, test_initialise_ignores_ealready_from_driver)
@@ -306,12 +441,553 @@ ZTEST(focuser_app, test_eeprom_position_store_roundtrip)
 	};
 
 	EepromPositionStore store;
-	store.save(0x2222);
+	store.save(PersistentState{.position = 0x2222});
 
 	EepromPositionStore store2;
-	uint16_t loaded = 0U;
+	PersistentState loaded{};
 	zassert_true(store2.load(loaded), "load should succeed after save");
-	zassert_equal(loaded, 0x2222, "loaded value should match saved");
+	zassert_equal(loaded.position, 0x2222, "loaded value should match saved");
+}
+
+ZTEST(focuser_app, test_motion_completion_is_event_driven)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	MockPositionStore store;
+	Focuser focuser(stepper, &store, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setNewPosition(0x0100);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled immediately");
+	zassert_equal(fake_stepper_move_to_fake.call_count, 1U, "move should start");
+	zassert_true((fake_stepper_move_to_fake.arg1_val > 0) &&
+		(fake_stepper_move_to_fake.arg1_val <= 0x0100), "first segment heads to the target");
+	zassert_equal(fake_stepper_drv_enable_fake.call_count, 1U, "driver enabled for motion");
+
+	const unsigned int is_moving_calls = fake_stepper_is_moving_fake.call_count;
+	zassert_equal(focuser.run_once(K_MSEC(20)), -EAGAIN,
+		"nothing should happen while the move is in progress");
+	zassert_equal(fake_stepper_is_moving_fake.call_count, is_moving_calls,
+		"the controller should not be polled while waiting for completion");
+
+	/* Each completed segment immediately starts the next one of the plan. */
+	unsigned int segments = 1U;
+	while (fake_stepper_move_to_fake.arg1_val != 0x0100)
+	{
+		zassert_true(segments < MotionPlan::kMaxSegments, "plan should reach the target");
+		raise_stepper_event(STEPPER_EVENT_STEPS_COMPLETED);
+		zassert_ok(focuser.run_once(K_NO_WAIT), "segment completion should be handled");
+		++segments;
+		zassert_equal(fake_stepper_move_to_fake.call_count, segments, "next segment started");
+		zassert_equal(fake_stepper_drv_disable_fake.call_count, 1U,
+			"driver should stay enabled between segments");
+		zassert_true(focuser.isMoving(), "planned motion reports moving between segments");
+	}
+
+	raise_stepper_event(STEPPER_EVENT_STEPS_COMPLETED);
+	zassert_ok(focuser.run_once(K_NO_WAIT), "completion should be handled immediately");
+	zassert_equal(fake_stepper_drv_disable_fake.call_count, 2U,
+		"driver should be disabled once the move completes");
+	zassert_equal(store.save_calls, 1U, "completed move should persist the position");
+	zassert_false(focuser.isMoving(), "motion should be over");
+}
+
+ZTEST(focuser_app, test_stop_request_ends_motion_immediately)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setNewPosition(0x0200);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled immediately");
+	zassert_true(focuser.isMoving(), "stepper should be moving");
+
+	focuser.stop();
+	const unsigned int stop_calls = fake_stepper_stop_fake.call_count;
+	zassert_ok(focuser.run_once(K_NO_WAIT), "stop request should be handled immediately");
+	zassert_equal(fake_stepper_stop_fake.call_count, stop_calls + 1U,
+		"focuser thread should stop the active move");
+
+	/* The STOPPED event of the cancelled move must not disturb a new one. */
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "second goto should start at once");
+	zassert_equal(fake_stepper_move_to_fake.call_count, 2U, "second move should start");
+	g_event_callback(k_stepper_controller, STEPPER_EVENT_STOPPED, g_event_user_data);
+	const unsigned int disable_calls = fake_stepper_drv_disable_fake.call_count;
+	zassert_ok(focuser.run_once(K_NO_WAIT), "stale event is still consumed");
+	zassert_equal(fake_stepper_drv_disable_fake.call_count, disable_calls,
+		"a stale event must not end a move that is still running");
+}
+
+ZTEST(focuser_app, test_new_target_ahead_retargets_without_stopping)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	start_accelerated_move(focuser, 0x1000);
+	g_stepper_position = 0x0200;
+	const unsigned int stop_calls = fake_stepper_stop_fake.call_count;
+
+	focuser.setNewPosition(0x2000);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "new target should be taken mid-move");
+	zassert_true((g_stepper_target > 0x0200) && (g_stepper_target < 0x2000),
+		"controller should get a waypoint of the new plan");
+
+	run_to_completion(focuser);
+	zassert_equal(g_stepper_position, 0x2000, "focuser should end at the new target");
+	zassert_equal(fake_stepper_stop_fake.call_count, stop_calls, "motor should never stop");
+	zassert_equal(fake_stepper_drv_disable_fake.call_count, 2U,
+		"driver should only be disabled at init and at the end");
+}
+
+ZTEST(focuser_app, test_new_target_behind_decelerates_then_reverses)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	start_accelerated_move(focuser, 0x1000);
+	g_stepper_position = 0x0200;
+	const unsigned int stop_calls = fake_stepper_stop_fake.call_count;
+
+	focuser.setNewPosition(0x0100);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "new target should be taken mid-move");
+	zassert_true(g_stepper_target > 0x0200, "motor should decelerate in its current direction");
+	zassert_true(g_stepper_target < 0x1000, "deceleration should not run to the stale target");
+
+	run_to_completion(focuser);
+	zassert_equal(g_stepper_position, 0x0100, "focuser should end at the new target");
+	zassert_equal(fake_stepper_stop_fake.call_count, stop_calls,
+		"reversal should decelerate rather than stop abruptly");
+}
+
+ZTEST(focuser_app, test_status_flags_failed_move_until_next_move)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setHalfStep(true);
+	focuser.setNewPosition(0x0100);
+	moonlite::Status status = focuser.getStatus();
+	zassert_equal(status.target, 0x0100, "XS target matches GN");
+	zassert_equal(status.flags, moonlite::kStatusHalfStep, "idle, half-step, no fault");
+
+	fake_stepper_move_to_fake.custom_fake = nullptr;
+	fake_stepper_move_to_fake.return_val = -EIO;
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	status = focuser.getStatus();
+	zassert_true((status.flags & moonlite::kStatusFault) != 0U, "failed move is reported");
+	zassert_true((status.flags & moonlite::kStatusMoving) == 0U, "failed move is not moving");
+
+	fake_stepper_move_to_fake.return_val = 0;
+	install_motion_fakes();
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "retry should be handled");
+	status = focuser.getStatus();
+	zassert_equal(status.flags, moonlite::kStatusMoving | moonlite::kStatusHalfStep,
+		"a move that starts clears the fault");
+}
+
+ZTEST(focuser_app, test_go_extensions_move_in_one_request)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.goToPosition(0x0400);
+	zassert_equal(focuser.getNewPosition(), 0x0400, "XG stages the target like SN");
+	zassert_ok(focuser.run_once(K_NO_WAIT), "XG request should be handled");
+	zassert_true(focuser.isMoving(), "XG starts the move like FG");
+
+	/* Nudges while moving count from the target, not the moving position. */
+	focuser.moveRelative(0x0010);
+	focuser.moveRelative(0x0010);
+	zassert_equal(focuser.getNewPosition(), 0x0420, "nudges accumulate on the target");
+	run_to_completion(focuser);
+	zassert_equal(g_stepper_position, 0x0420, "focuser should reach the nudged target");
+
+	focuser.moveRelative(-0x0500);
+	zassert_equal(focuser.getNewPosition(), 0x0000, "relative move clamps at zero");
+	zassert_ok(focuser.run_once(K_NO_WAIT), "XR request should be handled");
+	run_to_completion(focuser);
+	zassert_equal(g_stepper_position, 0x0000, "focuser should stop at zero");
+}
+
+ZTEST(focuser_app, test_notifications_report_how_moves_end)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	static char log[4U * moonlite::kNotificationLength + 1U];
+	static size_t log_length;
+	log_length = 0U;
+	focuser.set_notification_callback(
+		[](moonlite::Notification notification, uint16_t position, void *) {
+			log_length += moonlite::writeNotification(&log[log_length], notification,
+								  position);
+		},
+		nullptr);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setNewPosition(0x0040);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	run_to_completion(focuser);
+	zassert_equal(log_length, 0U, "notifications are off until XN01");
+
+	focuser.setNotifications(true);
+	focuser.setNewPosition(0x0080);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	run_to_completion(focuser);
+
+	start_accelerated_move(focuser, 0x1000);
+	focuser.stop();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "stop request should be handled");
+
+	fake_stepper_move_to_fake.custom_fake = nullptr;
+	fake_stepper_move_to_fake.return_val = -EIO;
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	fake_stepper_move_to_fake.return_val = 0;
+	install_motion_fakes();
+
+	log[log_length] = '\0';
+	TC_PRINT("notifications: %s\n", log);
+	zassert_equal(log_length, 3U * moonlite::kNotificationLength, "one frame per move");
+	zassert_mem_equal(log, "!C0080#", moonlite::kNotificationLength, "completed move");
+	zassert_equal(log[moonlite::kNotificationLength + 1], 'Q', "FQ cancels the move");
+	zassert_equal(log[2U * moonlite::kNotificationLength + 1], 'F', "failed move");
+}
+
+ZTEST(focuser_app, test_motion_program_runs_points_back_to_back)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	static char log[4U * moonlite::kNotificationLength + 1U];
+	static size_t log_length;
+	log_length = 0U;
+	focuser.set_notification_callback(
+		[](moonlite::Notification notification, uint16_t position, void *) {
+			log_length += moonlite::writeNotification(&log[log_length], notification,
+								  position);
+		},
+		nullptr);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+	focuser.setNotifications(true);
+
+	constexpr uint16_t kDwellMs = 20U;
+	focuser.clearProgram();
+	focuser.addProgramPoint(0x0100);
+	focuser.setProgramDwell(kDwellMs);
+	focuser.addProgramPoint(0x0200);
+	focuser.addProgramPoint(0x0180);
+	focuser.runProgram();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "program request should be handled");
+	zassert_true(focuser.getStatus().flags & moonlite::kStatusProgram, "XS shows the program");
+
+	const int64_t start = k_uptime_get();
+	for (int i = 0; (i < 200) && (focuser.getStatus().flags & moonlite::kStatusProgram); ++i)
+	{
+		if (focuser.isMoving())
+		{
+			raise_stepper_event(STEPPER_EVENT_STEPS_COMPLETED);
+		}
+		(void)focuser.run_once(K_MSEC(100));
+	}
+	const int64_t elapsed_ms = k_uptime_get() - start;
+
+	log[log_length] = '\0';
+	TC_PRINT("program notifications: %s in %u ms\n", log, static_cast<unsigned int>(elapsed_ms));
+	zassert_false(focuser.getStatus().flags & moonlite::kStatusProgram, "program should end");
+	zassert_equal(log_length, 4U * moonlite::kNotificationLength, "one frame per point and the end");
+	zassert_mem_equal(log, "!P0100#!P0200#!P0180#!C0180#", log_length, "notification order");
+	zassert_true(elapsed_ms >= 2 * kDwellMs, "dwells at the last two points");
+
+	for (uint8_t i = 0; i < 3U; ++i)
+	{
+		const Focuser::ProgramPointStats stats = focuser.program_point_stats(i);
+		TC_PRINT("point %u: planned %u ms, moved %u ms, dwelled %u ms\n", i, stats.planned_ms,
+			 stats.move_ms, stats.dwell_ms);
+		zassert_true(stats.planned_ms > 0U, "planned time of point %u", i);
+		zassert_equal(focuser.getProgramPointTime(i), stats.move_ms, "XT reports point %u", i);
+		zassert_true(stats.dwell_ms >= ((i == 0U) ? 0U : kDwellMs), "dwell of point %u", i);
+	}
+}
+
+ZTEST(focuser_app, test_stop_ends_motion_program)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.clearProgram();
+	focuser.setProgramDwell(1000U);
+	focuser.addProgramPoint(0x0100);
+	focuser.addProgramPoint(0x0200);
+	focuser.runProgram();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "program request should be handled");
+	run_to_completion(focuser);
+
+	/* Dwelling at the first point. */
+	zassert_true(focuser.getStatus().flags & moonlite::kStatusProgram, "program still running");
+	focuser.stop();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "stop request should be handled");
+	zassert_false(focuser.getStatus().flags & moonlite::kStatusProgram, "FQ ends the program");
+	zassert_equal(g_stepper_target, 0x0100, "second point never started");
+	zassert_equal(focuser.program_point_stats(1).move_ms, 0U, "second point not reached");
+}
+
+ZTEST(focuser_app, test_program_sent_while_dwelling_replaces_the_old_one)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	static char log[4U * moonlite::kNotificationLength + 1U];
+	static size_t log_length;
+	log_length = 0U;
+	focuser.set_notification_callback(
+		[](moonlite::Notification notification, uint16_t position, void *) {
+			log_length += moonlite::writeNotification(&log[log_length], notification,
+								  position);
+		},
+		nullptr);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+	focuser.setNotifications(true);
+
+	constexpr uint16_t kDwellMs = 20U;
+	focuser.clearProgram();
+	focuser.setProgramDwell(kDwellMs);
+	focuser.addProgramPoint(0x0100);
+	focuser.addProgramPoint(0x0200);
+	focuser.runProgram();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "program request should be handled");
+	run_to_completion(focuser);
+
+	/* Dwelling at 0x0100 when the next program arrives. */
+	focuser.clearProgram();
+	focuser.setProgramDwell(0U);
+	focuser.addProgramPoint(0x0180);
+	focuser.runProgram();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "second program request should be handled");
+	zassert_true(focuser.isMoving(), "first point of the new program started");
+
+	/* Hold the move past the old dwell; it must not advance the new program. */
+	k_msleep(2 * kDwellMs);
+	(void)focuser.run_once(K_NO_WAIT);
+	zassert_true(focuser.isMoving(), "still moving to the new first point");
+	zassert_equal(log_length, moonlite::kNotificationLength, "old dwell reported nothing");
+
+	for (int i = 0; (i < 200) && (focuser.getStatus().flags & moonlite::kStatusProgram); ++i)
+	{
+		if (focuser.isMoving())
+		{
+			raise_stepper_event(STEPPER_EVENT_STEPS_COMPLETED);
+		}
+		(void)focuser.run_once(K_MSEC(10));
+	}
+
+	log[log_length] = '\0';
+	TC_PRINT("program notifications: %s\n", log);
+	zassert_mem_equal(log, "!P0100#!P0180#!C0180#", log_length, "one completion, new points");
+	zassert_equal(log_length, 3U * moonlite::kNotificationLength, "no stale completion");
+	zassert_true(focuser.program_point_stats(0).move_ms > 0U, "new point 0 was moved to");
+	zassert_equal(focuser.program_point_stats(1).move_ms, 0U, "old point 1 never started");
+
+	/* An empty program replacing a dwelling one completes exactly once. */
+	focuser.clearProgram();
+	focuser.setProgramDwell(kDwellMs);
+	focuser.addProgramPoint(0x0100);
+	focuser.runProgram();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "program request should be handled");
+	run_to_completion(focuser);
+	log_length = 0U;
+	focuser.clearProgram();
+	focuser.runProgram();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "empty program request should be handled");
+	k_msleep(2 * kDwellMs);
+	(void)focuser.run_once(K_NO_WAIT);
+	zassert_equal(log_length, moonlite::kNotificationLength, "a single completion");
+	zassert_false(focuser.getStatus().flags & moonlite::kStatusProgram, "program ended");
+}
+
+ZTEST(focuser_app, test_jog_keepalives_cost_no_driver_calls)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+	constexpr int kRepeats = 10;
+	constexpr int16_t kRate = CONFIG_APP_FOCUSER_START_SPEED;
+	g_stepper_position = 0x0800;
+	focuser.setCurrentPosition(0x0800);
+
+	const unsigned int run_calls = fake_stepper_run_fake.call_count;
+	focuser.jog(kRate);
+	zassert_ok(focuser.run_once(K_NO_WAIT), "jog request should be handled");
+	zassert_equal(fake_stepper_run_fake.call_count, run_calls + 1U, "jog runs the motor");
+	zassert_equal(fake_stepper_run_fake.arg1_val, STEPPER_DIRECTION_POSITIVE, "outward");
+	zassert_true(focuser.isMoving(), "jogging reports moving");
+
+	/* At the start speed there is no ramp, so a keepalive is pure bookkeeping. */
+	const unsigned int jog_before = driver_calls();
+	for (int i = 0; i < kRepeats; ++i)
+	{
+		focuser.jog(kRate);
+		zassert_ok(focuser.run_once(K_NO_WAIT), "keepalive should be handled");
+	}
+	const unsigned int jog_calls = driver_calls() - jog_before;
+	zassert_true(focuser.isMoving(), "keepalives keep the jog going");
+
+	/* Reversing stops first, then runs the other way. */
+	focuser.jog(-kRate);
+	zassert_ok(focuser.run_once(K_NO_WAIT), "reversal should be handled");
+	(void)focuser.run_once(K_NO_WAIT);
+	zassert_equal(fake_stepper_run_fake.call_count, run_calls + 2U, "jog restarts inward");
+	zassert_equal(fake_stepper_run_fake.arg1_val, STEPPER_DIRECTION_NEGATIVE, "inward");
+
+	focuser.jog(0);
+	zassert_ok(focuser.run_once(K_NO_WAIT), "release should be handled");
+	zassert_false(focuser.isMoving(), "a zero rate stops the jog");
+
+	/* The same hand control done with XR nudges. */
+	const unsigned int nudge_before = driver_calls();
+	for (int i = 0; i < kRepeats; ++i)
+	{
+		focuser.moveRelative(kRate / 10);
+		zassert_ok(focuser.run_once(K_NO_WAIT), "nudge should be handled");
+		run_to_completion(focuser);
+	}
+	const unsigned int nudge_calls = driver_calls() - nudge_before;
+
+	TC_PRINT("%d hand-control updates: %u driver call(s) jogging, %u with XR nudges\n", kRepeats,
+		 jog_calls, nudge_calls);
+	zassert_equal(jog_calls, 0U, "keepalives should not touch the controller");
+	zassert_true(nudge_calls >= 3U * kRepeats, "each nudge enables, times and moves");
+}
+
+ZTEST(focuser_app, test_jog_decelerates_when_keepalive_expires)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	const unsigned int interval_calls = fake_stepper_set_microstep_interval_fake.call_count;
+	const unsigned int move_calls = fake_stepper_move_to_fake.call_count;
+	const unsigned int stop_calls = fake_stepper_stop_fake.call_count;
+	const int64_t start = k_uptime_get();
+	while ((k_uptime_get() - start) < 2 * CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS)
+	{
+		/* Keepalives at a quarter of the timeout, as a key-repeat timer sends them. */
+		focuser.jog(CONFIG_APP_FOCUSER_MAX_SPEED);
+		const int64_t next = k_uptime_get() + (CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS / 4);
+		while (k_uptime_get() < next)
+		{
+			(void)focuser.run_once(K_MSEC(CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS / 4));
+		}
+	}
+	zassert_true(fake_stepper_set_microstep_interval_fake.call_count > interval_calls + 1U,
+		"jog should ramp up through several speeds");
+	zassert_equal(fake_stepper_move_to_fake.call_count, move_calls, "no moves while jogging");
+
+	/* The client goes silent. */
+	const int64_t silent = k_uptime_get();
+	while (fake_stepper_move_to_fake.call_count == move_calls)
+	{
+		zassert_true((k_uptime_get() - silent) < 2 * CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS,
+			"jog should time out");
+		(void)focuser.run_once(K_MSEC(CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS));
+	}
+	const int64_t expired_ms = k_uptime_get() - silent;
+
+	TC_PRINT("jog stopped %u ms after the last keepalive (timeout %u ms)\n",
+		 static_cast<unsigned int>(expired_ms), CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS);
+	zassert_true(expired_ms >= CONFIG_APP_FOCUSER_JOG_KEEPALIVE_MS / 2, "not before the timeout");
+	zassert_true(g_stepper_target > g_stepper_position, "decelerates ahead, without reversing");
+	zassert_equal(fake_stepper_stop_fake.call_count, stop_calls, "ramped down, not stopped hard");
+	run_to_completion(focuser);
+}
+
+ZTEST(focuser_app, test_relative_move_during_jog_counts_from_the_jog)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	/* The last XG target stays behind while the jog runs elsewhere. */
+	focuser.goToPosition(0x0100);
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	run_to_completion(focuser);
+	g_stepper_position = 0x0800;
+	focuser.setCurrentPosition(0x0800);
+
+	focuser.jog(CONFIG_APP_FOCUSER_START_SPEED);
+	zassert_ok(focuser.run_once(K_NO_WAIT), "jog request should be handled");
+	k_msleep(20);
+	const uint16_t position = focuser.getCurrentPosition();
+	zassert_true(position > 0x0800, "jogging outward");
+
+	focuser.moveRelative(0x0010);
+	const uint16_t target = focuser.getNewPosition();
+	TC_PRINT("XR+16 at 0x%04x while jogging -> 0x%04x\n", position, target);
+	zassert_true((target >= position + 0x0010U) && (target <= position + 0x0020U),
+		     "XR counts from the jog position, not the old target");
+}
+
+ZTEST(focuser_app, test_stop_ends_jog_immediately)
+{
+	assert_stepper_devices_ready();
+	install_motion_fakes();
+	ZephyrFocuserStepper stepper(k_stepper_controller, k_stepper_driver);
+	Focuser focuser(stepper, nullptr, kFirmwareVersion);
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	g_stepper_position = 0x0800;
+	focuser.setCurrentPosition(0x0800);
+	focuser.jog(-CONFIG_APP_FOCUSER_START_SPEED);
+	zassert_ok(focuser.run_once(K_NO_WAIT), "jog request should be handled");
+	zassert_true(focuser.isMoving(), "jogging inward");
+
+	/* A keepalive already queued must not restart the motor after FQ. */
+	const unsigned int run_calls = fake_stepper_run_fake.call_count;
+	const unsigned int stop_calls = fake_stepper_stop_fake.call_count;
+	focuser.jog(-CONFIG_APP_FOCUSER_START_SPEED);
+	focuser.stop();
+	zassert_equal(fake_stepper_stop_fake.call_count, stop_calls + 1U,
+		"FQ stops the controller before returning");
+	zassert_ok(focuser.run_once(K_NO_WAIT), "stop request should be handled");
+	(void)focuser.run_once(K_NO_WAIT);
+	zassert_false(focuser.isMoving(), "FQ ends the jog");
+	zassert_equal(fake_stepper_run_fake.call_count, run_calls, "jog not restarted");
 }
 
 ZTEST_SUITE(focuser_app, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,296 @@
+#include <zephyr/ztest.h>
+
+#include <errno.h>
+
+#include <cstdint>
+
+#include "Focuser.hpp"
+#include "MotionPlanner.hpp"
+
+namespace
+{
+
+constexpr MotionProfile kRampedProfile{
+	.max_speed = CONFIG_APP_FOCUSER_MAX_SPEED,
+	.start_speed = CONFIG_APP_FOCUSER_START_SPEED,
+	.acceleration = CONFIG_APP_FOCUSER_ACCELERATION,
+};
+
+/* Without ramps a heavy train can only be moved at its start/stop speed. */
+constexpr MotionProfile kStartStopProfile{
+	.max_speed = CONFIG_APP_FOCUSER_START_SPEED,
+	.start_speed = CONFIG_APP_FOCUSER_START_SPEED,
+	.acceleration = 0U,
+};
+
+/* Before ramps every move ran at one constant 2000 steps/s at Moonlite speed 1. */
+constexpr MotionProfile kConstantSpeedProfile{
+	.max_speed = 2000U,
+	.start_speed = 2000U,
+	.acceleration = 0U,
+};
+
+uint32_t segment_speed(const MotionSegment &segment)
+{
+	return static_cast<uint32_t>(1000000000ULL / segment.interval_ns);
+}
+
+/* Executes moves instantly while accumulating the time the real motor would
+ * need, and reports each completed move through the event callback.
+ */
+class SimulatedStepper final : public FocuserStepper
+{
+public:
+	bool is_ready() const override
+	{
+		return true;
+	}
+
+	int set_reference_position(int32_t position) override
+	{
+		m_position = position;
+		return 0;
+	}
+
+	int set_microstep_interval(uint64_t interval_ns) override
+	{
+		m_interval_ns = interval_ns;
+		return 0;
+	}
+
+	int move_to(int32_t target) override
+	{
+		const int64_t steps = (target > m_position) ? (target - m_position) : (m_position - target);
+		elapsed_ns += static_cast<uint64_t>(steps) * m_interval_ns;
+		m_position = target;
+		++moves;
+		if (m_callback != nullptr)
+		{
+			m_callback(Event::steps_completed, m_user_data);
+		}
+		return 0;
+	}
+
+	int run(Direction) override
+	{
+		return -ENOTSUP;
+	}
+
+	int is_moving(bool &moving) override
+	{
+		moving = false;
+		return 0;
+	}
+
+	int stop() override
+	{
+		return 0;
+	}
+
+	int get_actual_position(int32_t &position) override
+	{
+		position = m_position;
+		return 0;
+	}
+
+	int enable_driver(bool) override
+	{
+		return 0;
+	}
+
+	int set_event_callback(EventCallback callback, void *user_data) override
+	{
+		m_callback = callback;
+		m_user_data = user_data;
+		return 0;
+	}
+
+	uint64_t elapsed_ns{0U};
+	unsigned int moves{0U};
+
+private:
+	int32_t m_position{0};
+	uint64_t m_interval_ns{0U};
+	EventCallback m_callback{nullptr};
+	void *m_user_data{nullptr};
+};
+
+} // namespace
+
+ZTEST(motion_planner, test_zero_distance_has_no_segments)
+{
+	zassert_true(plan_move(0U, kRampedProfile).empty(), "nothing to do for a zero-length move");
+}
+
+ZTEST(motion_planner, test_without_acceleration_runs_at_constant_speed)
+{
+	const MotionPlan plan = plan_move(500U, kStartStopProfile);
+
+	zassert_equal(plan.size(), 1U, "constant-speed move is one segment");
+	zassert_equal(plan[0].steps, 500U, "segment covers the distance");
+	zassert_equal(segment_speed(plan[0]), CONFIG_APP_FOCUSER_START_SPEED, "runs at max speed");
+}
+
+ZTEST(motion_planner, test_ramp_is_symmetric_and_covers_distance)
+{
+	for (const uint32_t distance : {1U, 2U, 7U, 100U, 1000U, 10000U, 65535U})
+	{
+		const MotionPlan plan = plan_move(distance, kRampedProfile);
+
+		zassert_equal(plan.total_steps(), distance, "plan must cover %u steps exactly", distance);
+		zassert_true(segment_speed(plan[0]) <= CONFIG_APP_FOCUSER_MAX_SPEED, "bounded start");
+		for (std::size_t i = 0; i < plan.size(); ++i)
+		{
+			zassert_equal(plan[i].steps, plan[plan.size() - 1U - i].steps,
+				"ramp down mirrors ramp up (%u steps)", distance);
+			zassert_true(segment_speed(plan[i]) <= CONFIG_APP_FOCUSER_MAX_SPEED,
+				"speed limit exceeded (%u steps)", distance);
+		}
+	}
+}
+
+ZTEST(motion_planner, test_moves_start_and_end_at_start_speed)
+{
+	const uint64_t start_interval_ns = 1000000000ULL / CONFIG_APP_FOCUSER_START_SPEED;
+	for (const uint32_t distance : {1U, 2U, 7U, 100U, 1000U, 10000U, 65535U})
+	{
+		const MotionPlan plan = plan_move(distance, kRampedProfile);
+
+		zassert_true(plan[0].interval_ns >= start_interval_ns,
+			"first segment above the start speed (%u steps)", distance);
+		zassert_true(plan[plan.size() - 1U].interval_ns >= start_interval_ns,
+			"last segment above the start speed (%u steps)", distance);
+	}
+	const MotionPlan stop = plan_stop(CONFIG_APP_FOCUSER_MAX_SPEED, kRampedProfile);
+	zassert_true(stop[stop.size() - 1U].interval_ns >= start_interval_ns,
+		"a stop ends at the start speed");
+}
+
+ZTEST(motion_planner, test_long_move_accelerates_to_max_speed)
+{
+	const MotionPlan plan = plan_move(20000U, kRampedProfile);
+	const std::size_t cruise = plan.size() / 2U;
+
+	zassert_equal(plan.size(), MotionPlan::kMaxSegments, "ramp up, cruise, ramp down");
+	zassert_equal(segment_speed(plan[cruise]), CONFIG_APP_FOCUSER_MAX_SPEED, "cruise at max");
+	for (std::size_t i = 1; i <= cruise; ++i)
+	{
+		zassert_true(plan[i].interval_ns < plan[i - 1U].interval_ns, "speed rises to cruise");
+	}
+	zassert_true(segment_speed(plan[0]) <= CONFIG_APP_FOCUSER_START_SPEED,
+		"first stage runs at the start speed");
+}
+
+ZTEST(motion_planner, test_plan_from_speed_continues_without_restart)
+{
+	const uint32_t speed = CONFIG_APP_FOCUSER_MAX_SPEED / 2U;
+	for (const uint32_t distance : {stopping_distance(speed, kRampedProfile), 1000U, 20000U})
+	{
+		const MotionPlan plan = plan_move(distance, kRampedProfile, speed);
+
+		zassert_equal(plan.total_steps(), distance, "plan must cover %u steps", distance);
+		zassert_true(segment_speed(plan[0]) + (CONFIG_APP_FOCUSER_MAX_SPEED / 8U) >= speed,
+			"plan should not drop back to the start speed (%u steps)", distance);
+		zassert_true(segment_speed(plan[plan.size() - 1U]) <
+				(2U * CONFIG_APP_FOCUSER_START_SPEED + CONFIG_APP_FOCUSER_MAX_SPEED / 8U),
+			"plan should still end slow (%u steps)", distance);
+	}
+}
+
+ZTEST(motion_planner, test_stop_plan_decelerates_over_stopping_distance)
+{
+	const uint32_t speed = CONFIG_APP_FOCUSER_MAX_SPEED;
+	const MotionPlan plan = plan_stop(speed, kRampedProfile);
+
+	zassert_equal(plan.total_steps(), stopping_distance(speed, kRampedProfile),
+		"stop plan covers the stopping distance");
+	for (std::size_t i = 1; i < plan.size(); ++i)
+	{
+		zassert_true(plan[i].interval_ns > plan[i - 1U].interval_ns, "speed only falls");
+	}
+	zassert_true(plan_stop(CONFIG_APP_FOCUSER_START_SPEED, kRampedProfile).empty(),
+		"no ramp needed at the start speed");
+}
+
+ZTEST(motion_planner, test_focuser_executes_plan_to_target)
+{
+	SimulatedStepper stepper;
+	Focuser focuser(stepper, nullptr, "sim");
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setNewPosition(0x2000);
+	focuser.goToNewPosition();
+	while (focuser.run_once(K_NO_WAIT) == 0)
+	{
+	}
+
+	int32_t position = 0;
+	zassert_ok(stepper.get_actual_position(position), "position query");
+	zassert_equal(position, 0x2000, "focuser should reach the target");
+	zassert_equal(stepper.moves, plan_move(0x2000, kRampedProfile).size(),
+		"one controller move per plan segment");
+	zassert_false(focuser.isMoving(), "motion should be complete");
+}
+
+ZTEST(motion_planner, test_benchmark_time_to_target)
+{
+	TC_PRINT("%8s %14s %14s %14s\n", "steps", "ramped [ms]", "constant [ms]", "speedup [%]");
+	for (const uint16_t distance : {1U, 10U, 100U, 1000U, 5000U, 20000U, 60000U})
+	{
+		SimulatedStepper stepper;
+		Focuser focuser(stepper, nullptr, "sim");
+		zassert_ok(focuser.initialise(), "initialise precondition");
+
+		focuser.setNewPosition(distance);
+		focuser.goToNewPosition();
+		while (focuser.run_once(K_NO_WAIT) == 0)
+		{
+		}
+
+		const uint64_t ramped_us = stepper.elapsed_ns / 1000U;
+		const uint64_t constant_us = plan_move(distance, kConstantSpeedProfile).duration_us();
+		const uint64_t speedup_pct = (100U * constant_us) / ((ramped_us == 0U) ? 1U : ramped_us);
+		TC_PRINT("%8u %14u %14u %14u\n", distance, static_cast<unsigned int>(ramped_us / 1000U),
+			 static_cast<unsigned int>(constant_us / 1000U),
+			 static_cast<unsigned int>(speedup_pct));
+
+		zassert_equal(ramped_us, plan_move(distance, kRampedProfile).duration_us(),
+			"simulated time should match the plan");
+		zassert_true(ramped_us <= constant_us, "ramping should never be slower (%u steps)",
+			distance);
+		if (distance >= 20000U)
+		{
+			zassert_true(2U * ramped_us <= constant_us,
+				"long slews should take at most half the time (%u steps)", distance);
+		}
+	}
+}
+
+ZTEST(motion_planner, test_remaining_time_matches_simulated_move)
+{
+	TC_PRINT("%8s %12s %12s %12s\n", "steps", "queued [ms]", "started [ms]", "actual [ms]");
+	for (const uint16_t distance : {1U, 100U, 1000U, 5000U, 20000U, 60000U})
+	{
+		SimulatedStepper stepper;
+		Focuser focuser(stepper, nullptr, "sim");
+		zassert_ok(focuser.initialise(), "initialise precondition");
+
+		focuser.setNewPosition(distance);
+		focuser.goToNewPosition();
+		const uint32_t queued_ms = focuser.getRemainingMoveTime();
+		zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+		const uint32_t started_ms = focuser.getRemainingMoveTime();
+		while (focuser.run_once(K_NO_WAIT) == 0)
+		{
+		}
+
+		const uint32_t actual_ms = static_cast<uint32_t>((stepper.elapsed_ns + 999999U) / 1000000U);
+		TC_PRINT("%8u %12u %12u %12u\n", distance, queued_ms, started_ms, actual_ms);
+		zassert_equal(queued_ms, actual_ms, "estimate before the move starts (%u steps)", distance);
+		zassert_true((started_ms <= actual_ms) && (started_ms + 1U >= actual_ms),
+			"estimate once under way (%u steps)", distance);
+		zassert_equal(focuser.getRemainingMoveTime(), 0U, "nothing left once stopped");
+	}
+}
+
+ZTEST_SUITE(motion_planner, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,220 @@
+#include <zephyr/drivers/eeprom/eeprom_fake.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <errno.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "EepromPositionStore.hpp"
+#include "Focuser.hpp"
+#include "RetainedPositionStore.hpp"
+#include "ZephyrStepper.hpp"
+
+namespace
+{
+
+/* Roughly one 8-byte random read from an I2C EEPROM at 100 kHz. */
+constexpr uint32_t kEepromReadUs = 1000U;
+
+class CountingPositionStore final : public PositionStore
+{
+public:
+	bool load(PersistentState &state_out) override
+	{
+		++loads;
+		if (!has_value)
+		{
+			return false;
+		}
+		state_out = value;
+		return true;
+	}
+
+	void save(const PersistentState &state) override
+	{
+		value = state;
+		has_value = true;
+		++saves;
+	}
+
+	PersistentState value{};
+	bool has_value{false};
+	unsigned int loads{0U};
+	unsigned int saves{0U};
+};
+
+uint8_t g_eeprom[256];
+
+PersistentState at(uint16_t position)
+{
+	return PersistentState{.position = position};
+}
+
+/* Stands in for RAM left over from before a power cycle. */
+void cold_boot(RetainedPositionStore::Block &block)
+{
+	std::memset(&block, 0xA5, sizeof(block));
+}
+
+void retained_store_before(void *)
+{
+	std::memset(g_eeprom, 0xFF, sizeof(g_eeprom));
+
+	RESET_FAKE(fake_eeprom_read);
+	RESET_FAKE(fake_eeprom_write);
+	RESET_FAKE(fake_eeprom_size);
+	fake_eeprom_size_fake.custom_fake = [](const struct device *) -> size_t {
+		return sizeof(g_eeprom);
+	};
+	fake_eeprom_write_fake.custom_fake = [](const struct device *, off_t offset, const void *data,
+						size_t len) -> int {
+		if ((offset < 0) || (static_cast<size_t>(offset) + len > sizeof(g_eeprom)))
+		{
+			return -EINVAL;
+		}
+		std::memcpy(&g_eeprom[static_cast<size_t>(offset)], data, len);
+		return 0;
+	};
+	fake_eeprom_read_fake.custom_fake = [](const struct device *, off_t offset, void *data,
+					       size_t len) -> int {
+		if ((offset < 0) || (static_cast<size_t>(offset) + len > sizeof(g_eeprom)))
+		{
+			return -EINVAL;
+		}
+		k_busy_wait(kEepromReadUs);
+		std::memcpy(data, &g_eeprom[static_cast<size_t>(offset)], len);
+		return 0;
+	};
+}
+
+/* Boots a focuser on top of `store` and returns how long initialise() took. */
+uint32_t boot_focuser(PositionStore &store, uint16_t &position_out)
+{
+	ZephyrFocuserStepper stepper(DEVICE_DT_GET(DT_ALIAS(stepper)),
+				     DEVICE_DT_GET(DT_ALIAS(stepper_drv)));
+	Focuser focuser(stepper, &store, "retained");
+
+	const uint32_t start = k_cycle_get_32();
+	zassert_ok(focuser.initialise(), "initialise");
+	const uint32_t elapsed_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+	position_out = focuser.getCurrentPosition();
+	return elapsed_us;
+}
+
+} // namespace
+
+ZTEST(retained_store, test_cold_boot_falls_back_to_backing_store)
+{
+	CountingPositionStore backing;
+	RetainedPositionStore::Block block;
+	cold_boot(block);
+	backing.save(at(0x1234));
+
+	RetainedPositionStore store(backing, block);
+	PersistentState loaded{};
+	zassert_true(store.load(loaded), "backing store position");
+	zassert_equal(loaded.position, 0x1234, "position from backing store");
+	zassert_equal(store.last_load_source(), RetainedPositionStore::Source::backing, "source");
+	zassert_equal(backing.loads, 1U, "cold boot reads the backing store");
+}
+
+ZTEST(retained_store, test_warm_boot_skips_backing_store)
+{
+	CountingPositionStore backing;
+	RetainedPositionStore::Block block;
+	cold_boot(block);
+
+	{
+		RetainedPositionStore before_reset(backing, block);
+		before_reset.save(at(0x4321));
+	}
+	zassert_equal(backing.saves, 1U, "saves are forwarded to the backing store");
+
+	RetainedPositionStore after_reset(backing, block);
+	PersistentState loaded{};
+	zassert_true(after_reset.load(loaded), "retained position");
+	zassert_equal(loaded.position, 0x4321, "position from retained RAM");
+	zassert_equal(after_reset.last_load_source(), RetainedPositionStore::Source::retained,
+		"source");
+	zassert_equal(backing.loads, 0U, "warm boot must not read the backing store");
+}
+
+ZTEST(retained_store, test_corrupt_block_is_ignored)
+{
+	CountingPositionStore backing;
+	RetainedPositionStore::Block block;
+	cold_boot(block);
+
+	{
+		RetainedPositionStore before_reset(backing, block);
+		before_reset.save(at(0x0FF0));
+	}
+	backing.value.position = 0x0EE0;
+	block.payload[1] ^= 0x01U;
+
+	RetainedPositionStore after_reset(backing, block);
+	PersistentState loaded{};
+	zassert_true(after_reset.load(loaded), "fallback position");
+	zassert_equal(loaded.position, 0x0EE0, "corrupt block must not be trusted");
+	zassert_equal(after_reset.last_load_source(), RetainedPositionStore::Source::backing,
+		"source");
+}
+
+ZTEST(retained_store, test_nothing_stored_anywhere)
+{
+	CountingPositionStore backing;
+	RetainedPositionStore::Block block;
+	cold_boot(block);
+
+	RetainedPositionStore store(backing, block);
+	PersistentState loaded{};
+	zassert_false(store.load(loaded), "nothing to restore");
+	zassert_equal(store.last_load_source(), RetainedPositionStore::Source::none, "source");
+}
+
+ZTEST(retained_store, test_benchmark_boot_to_ready)
+{
+	RetainedPositionStore::Block block;
+	cold_boot(block);
+
+	{
+		/* Previous session: position saved to EEPROM and mirrored to RAM. */
+		EepromPositionStore eeprom;
+		RetainedPositionStore store(eeprom, block);
+		store.save(at(0x3456));
+	}
+
+	uint16_t position = 0U;
+	const unsigned int reads_before_warm = fake_eeprom_read_fake.call_count;
+	EepromPositionStore warm_eeprom;
+	RetainedPositionStore warm_store(warm_eeprom, block);
+	const uint32_t warm_us = boot_focuser(warm_store, position);
+	const unsigned int warm_reads = fake_eeprom_read_fake.call_count - reads_before_warm;
+	zassert_equal(position, 0x3456, "warm boot position");
+	zassert_equal(warm_store.last_load_source(), RetainedPositionStore::Source::retained,
+		"warm boot source");
+
+	cold_boot(block);
+	const unsigned int reads_before_cold = fake_eeprom_read_fake.call_count;
+	EepromPositionStore cold_eeprom;
+	RetainedPositionStore cold_store(cold_eeprom, block);
+	const uint32_t cold_us = boot_focuser(cold_store, position);
+	const unsigned int cold_reads = fake_eeprom_read_fake.call_count - reads_before_cold;
+	zassert_equal(position, 0x3456, "cold boot position");
+	zassert_equal(cold_store.last_load_source(), RetainedPositionStore::Source::backing,
+		"cold boot source");
+
+	TC_PRINT("%-6s %-14s %14s %14s\n", "boot", "source", "EEPROM reads", "init [us]");
+	TC_PRINT("%-6s %-14s %14u %14u\n", "cold",
+		 RetainedPositionStore::source_name(cold_store.last_load_source()), cold_reads, cold_us);
+	TC_PRINT("%-6s %-14s %14u %14u\n", "warm",
+		 RetainedPositionStore::source_name(warm_store.last_load_source()), warm_reads, warm_us);
+
+	zassert_equal(warm_reads, 0U, "warm boot must not touch the EEPROM");
+	zassert_true(cold_reads > 0U, "cold boot reads the EEPROM");
+}
+
+ZTEST_SUITE(retained_store, NULL, NULL, retained_store_before, NULL, NULL);
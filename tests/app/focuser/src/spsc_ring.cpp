@@ -0,0 +1,91 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "SpscRing.hpp"
+
+ZTEST(spsc_ring, test_push_pop_preserves_order_across_wrap)
+{
+	SpscRing<8> ring;
+	std::uint8_t out[8];
+
+	for (std::uint8_t round = 0; round < 5; ++round)
+	{
+		const std::uint8_t in[5] = {round, 1, 2, 3, 4};
+		zassert_equal(ring.push(in, sizeof(in)), sizeof(in), "push fits");
+		zassert_equal(ring.size(), sizeof(in), "size after push");
+		zassert_equal(ring.pop(out, sizeof(out)), sizeof(in), "pop drains");
+		zassert_mem_equal(out, in, sizeof(in), "order preserved on round %u", round);
+		zassert_true(ring.empty(), "empty after drain");
+	}
+}
+
+ZTEST(spsc_ring, test_push_stops_when_full)
+{
+	SpscRing<4> ring;
+	const std::uint8_t in[6] = {1, 2, 3, 4, 5, 6};
+	std::uint8_t out[6];
+
+	zassert_equal(ring.push(in, sizeof(in)), 4U, "only capacity bytes stored");
+	zassert_equal(ring.push(in, 1U), 0U, "full ring rejects more");
+	zassert_equal(ring.pop(out, 2U), 2U, "partial pop");
+	zassert_equal(ring.push(&in[4], 2U), 2U, "space reclaimed after pop");
+	zassert_equal(ring.pop(out, sizeof(out)), 4U, "remaining bytes");
+	zassert_mem_equal(out, "\x03\x04\x05\x06", 4U, "order preserved");
+}
+
+namespace
+{
+
+constexpr std::uint32_t kIsrBytes = 2000U;
+SpscRing<16> g_isr_ring;
+volatile std::uint32_t g_isr_next;
+
+void isr_producer(struct k_timer *)
+{
+	/* Runs in interrupt context, like the UART ISR; unstored bytes are retried next tick. */
+	std::uint8_t burst[5];
+	std::uint32_t count = 0U;
+	while ((count < sizeof(burst)) && (g_isr_next + count < kIsrBytes))
+	{
+		burst[count] = static_cast<std::uint8_t>(g_isr_next + count);
+		++count;
+	}
+
+	const std::size_t stored = g_isr_ring.push(burst, count);
+	g_isr_next = g_isr_next + static_cast<std::uint32_t>(stored);
+}
+
+K_TIMER_DEFINE(g_isr_timer, isr_producer, nullptr);
+
+} // namespace
+
+ZTEST(spsc_ring, test_isr_producer_thread_consumer)
+{
+	g_isr_next = 0U;
+	k_timer_start(&g_isr_timer, K_MSEC(1), K_MSEC(1));
+
+	std::uint32_t expected = 0U;
+	const int64_t deadline = k_uptime_get() + 10000;
+	while ((expected < kIsrBytes) && (k_uptime_get() < deadline))
+	{
+		std::uint8_t out[7];
+		const std::size_t count = g_isr_ring.pop(out, sizeof(out));
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			zassert_equal(out[i], static_cast<std::uint8_t>(expected), "byte %u out of order",
+				      expected);
+			++expected;
+		}
+		if (count == 0U)
+		{
+			k_usleep(300);
+		}
+	}
+
+	k_timer_stop(&g_isr_timer);
+	zassert_equal(expected, kIsrBytes, "consumer received every stored byte");
+}
+
+ZTEST_SUITE(spsc_ring, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,366 @@
+#include <zephyr/drivers/stepper/stepper_fake.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <errno.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "Focuser.hpp"
+#include "Seqlock.hpp"
+#include "ZephyrStepper.hpp"
+
+namespace
+{
+
+constexpr int kWriterPriority = K_PRIO_PREEMPT(2);
+constexpr int kReaderPriority = K_PRIO_PREEMPT(8);
+constexpr int32_t kRunTimeMs = 200;
+
+struct Payload
+{
+	uint32_t value{0U};
+	uint32_t inverse{~0U};
+	uint32_t sequence{0U};
+};
+
+K_THREAD_STACK_DEFINE(g_writer_stack, 1024);
+struct k_thread g_writer_thread;
+
+/* Shared between the writer thread and the reading test thread. */
+struct Contention
+{
+	k_mutex lock;
+	Payload guarded;
+	Seqlock<Payload> published;
+	bool publish_with_seqlock;
+	std::atomic<bool> stop;
+	uint32_t writes;
+	uint32_t max_lock_wait_cycles;
+};
+
+Contention g_contention;
+
+/* Stands in for the motion thread: updates the state under the mutex at a
+ * high rate and records how long it had to wait for the lock.
+ */
+void writer_entry(void *, void *, void *)
+{
+	uint32_t counter = 0U;
+	while (!g_contention.stop.load())
+	{
+		k_usleep(100);
+		++counter;
+
+		const uint32_t start = k_cycle_get_32();
+		k_mutex_lock(&g_contention.lock, K_FOREVER);
+		const uint32_t waited = k_cycle_get_32() - start;
+		if (waited > g_contention.max_lock_wait_cycles)
+		{
+			g_contention.max_lock_wait_cycles = waited;
+		}
+
+		const Payload next{counter, ~counter, counter};
+		g_contention.guarded = next;
+		if (g_contention.publish_with_seqlock)
+		{
+			g_contention.published.store(next);
+		}
+		++g_contention.writes;
+		k_mutex_unlock(&g_contention.lock);
+	}
+}
+
+struct PollResult
+{
+	uint32_t reads{0U};
+	uint32_t torn{0U};
+	uint32_t writer_wait_cycles{0U};
+	uint32_t writes{0U};
+};
+
+/* Polls the payload as fast as possible for kRunTimeMs while the writer runs. */
+PollResult poll_under_contention(bool use_seqlock)
+{
+	k_mutex_init(&g_contention.lock);
+	g_contention.guarded = Payload{};
+	g_contention.published.store(Payload{});
+	g_contention.publish_with_seqlock = use_seqlock;
+	g_contention.stop = false;
+	g_contention.writes = 0U;
+	g_contention.max_lock_wait_cycles = 0U;
+
+	const int previous_priority = k_thread_priority_get(k_current_get());
+	k_thread_priority_set(k_current_get(), kReaderPriority);
+	k_thread_create(&g_writer_thread, g_writer_stack, K_THREAD_STACK_SIZEOF(g_writer_stack),
+			writer_entry, nullptr, nullptr, nullptr, kWriterPriority, 0, K_NO_WAIT);
+
+	PollResult result;
+	const int64_t deadline = k_uptime_get() + kRunTimeMs;
+	while (k_uptime_get() < deadline)
+	{
+		Payload copy;
+		if (use_seqlock)
+		{
+			copy = g_contention.published.load();
+		}
+		else
+		{
+			k_mutex_lock(&g_contention.lock, K_FOREVER);
+			copy = g_contention.guarded;
+			k_mutex_unlock(&g_contention.lock);
+		}
+
+		if ((copy.inverse != ~copy.value) || (copy.sequence != copy.value))
+		{
+			++result.torn;
+		}
+		++result.reads;
+	}
+
+	g_contention.stop = true;
+	k_thread_join(&g_writer_thread, K_FOREVER);
+	k_thread_priority_set(k_current_get(), previous_priority);
+
+	result.writer_wait_cycles = g_contention.max_lock_wait_cycles;
+	result.writes = g_contention.writes;
+	return result;
+}
+
+/* Steps in real time at the programmed interval and counts how often the
+ * focuser asks for the position. Has no motion events, so the focuser polls.
+ */
+class TimedStepper final : public FocuserStepper
+{
+public:
+	bool is_ready() const override
+	{
+		return true;
+	}
+
+	int set_reference_position(int32_t position) override
+	{
+		m_origin = position;
+		m_target = position;
+		return 0;
+	}
+
+	int set_microstep_interval(uint64_t interval_ns) override
+	{
+		/* Steps already taken keep the old interval. */
+		m_origin = position_now();
+		m_start_cycles = k_cycle_get_32();
+		m_interval_ns = interval_ns;
+		return 0;
+	}
+
+	int move_to(int32_t target) override
+	{
+		m_origin = position_now();
+		m_target = target;
+		m_start_cycles = k_cycle_get_32();
+		return 0;
+	}
+
+	int run(Direction) override
+	{
+		return -ENOTSUP;
+	}
+
+	int is_moving(bool &moving) override
+	{
+		moving = (position_now() != m_target);
+		return 0;
+	}
+
+	int stop() override
+	{
+		m_origin = position_now();
+		m_target = m_origin;
+		return 0;
+	}
+
+	int get_actual_position(int32_t &position) override
+	{
+		position = position_now();
+		++position_reads;
+		return 0;
+	}
+
+	int enable_driver(bool) override
+	{
+		return 0;
+	}
+
+	int set_event_callback(EventCallback, void *) override
+	{
+		return -ENOTSUP;
+	}
+
+	/* Where the motor is, without counting as a driver query. */
+	int32_t position_now() const
+	{
+		const uint64_t elapsed_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - m_start_cycles);
+		const int32_t distance = (m_target > m_origin) ? (m_target - m_origin) : (m_origin - m_target);
+		const uint64_t done = (m_interval_ns == 0U) ? 0U : (elapsed_ns / m_interval_ns);
+		const int32_t steps = (done < static_cast<uint64_t>(distance)) ? static_cast<int32_t>(done)
+										: distance;
+		return (m_target > m_origin) ? (m_origin + steps) : (m_origin - steps);
+	}
+
+	unsigned int position_reads{0U};
+
+private:
+	int32_t m_origin{0};
+	int32_t m_target{0};
+	uint64_t m_interval_ns{0U};
+	uint32_t m_start_cycles{0U};
+};
+
+} // namespace
+
+ZTEST(state_snapshot, test_seqlock_round_trip)
+{
+	Seqlock<Payload> lock;
+	zassert_equal(lock.sequence(), 0U, "fresh seqlock has no stores");
+
+	lock.store(Payload{7U, ~7U, 7U});
+	const Payload copy = lock.load();
+
+	zassert_equal(copy.value, 7U, "stored value should be read back");
+	zassert_equal(copy.inverse, ~7U, "all fields should be read back");
+	zassert_equal(lock.sequence(), 2U, "one completed store advances the sequence by two");
+}
+
+ZTEST(state_snapshot, test_getters_do_not_touch_stepper_or_lock)
+{
+	ZephyrFocuserStepper stepper(DEVICE_DT_GET(DT_ALIAS(stepper)),
+				     DEVICE_DT_GET(DT_ALIAS(stepper_drv)));
+	Focuser focuser(stepper, nullptr, "snapshot");
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setCurrentPosition(0x1234);
+	focuser.setNewPosition(0x2345);
+	focuser.setSpeed(4);
+	focuser.setHalfStep(true);
+
+	const unsigned int position_reads = fake_stepper_get_actual_position_fake.call_count;
+	const unsigned int moving_reads = fake_stepper_is_moving_fake.call_count;
+
+	zassert_equal(focuser.getCurrentPosition(), 0x1234, "GP served from snapshot");
+	zassert_equal(focuser.getNewPosition(), 0x2345, "GN served from snapshot");
+	zassert_equal(focuser.getSpeed(), 4, "GD served from snapshot");
+	zassert_true(focuser.isHalfStep(), "GH served from snapshot");
+	zassert_false(focuser.isMoving(), "GI served from snapshot");
+	const moonlite::Status status = focuser.getStatus();
+	zassert_equal(status.position, 0x1234, "XS position served from snapshot");
+	zassert_equal(status.target, 0x2345, "XS target served from snapshot");
+	zassert_equal(status.flags, moonlite::kStatusHalfStep, "XS flags served from snapshot");
+
+	zassert_equal(fake_stepper_get_actual_position_fake.call_count, position_reads,
+		"GP must not query the stepper driver");
+	zassert_equal(fake_stepper_is_moving_fake.call_count, moving_reads,
+		"GI must not query the stepper driver");
+
+	const Focuser::Snapshot snapshot = focuser.snapshot();
+	zassert_equal(snapshot.position, 0x1234, "snapshot position");
+	zassert_equal(snapshot.new_position, 0x2345, "snapshot new position");
+}
+
+ZTEST(state_snapshot, test_position_interpolated_during_motion)
+{
+	TimedStepper stepper;
+	Focuser focuser(stepper, nullptr, "interpolated");
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setNewPosition(600U);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	const unsigned int reads_at_start = stepper.position_reads;
+
+	uint32_t samples = 0U;
+	int32_t max_error = 0;
+	uint32_t min_cycles = UINT32_MAX;
+	uint32_t max_cycles = 0U;
+	while (focuser.isMoving())
+	{
+		const int32_t before = stepper.position_now();
+		const uint32_t start = k_cycle_get_32();
+		const int32_t estimate = focuser.getCurrentPosition();
+		const uint32_t cycles = k_cycle_get_32() - start;
+		const int32_t after = stepper.position_now();
+
+		/* The motor may step while GP runs; only error outside that span counts. */
+		const int32_t error = (estimate < before) ? (before - estimate)
+							  : ((estimate > after) ? (estimate - after) : 0);
+		max_error = (error > max_error) ? error : max_error;
+		min_cycles = (cycles < min_cycles) ? cycles : min_cycles;
+		max_cycles = (cycles > max_cycles) ? cycles : max_cycles;
+		++samples;
+
+		(void)focuser.run_once(K_NO_WAIT);
+		k_busy_wait(500);
+	}
+
+	TC_PRINT("%u GP samples: max error %d step(s), latency %u..%u us, %u driver query(ies)\n",
+		 samples, max_error, k_cyc_to_us_floor32(min_cycles), k_cyc_to_us_floor32(max_cycles),
+		 stepper.position_reads);
+	zassert_true(samples > 100U, "the move should span many polls");
+	zassert_true(max_error <= 1, "interpolated position within one step (%d)", max_error);
+	zassert_equal(stepper.position_reads - reads_at_start, 1U,
+		"only the end of the move queries the driver");
+	zassert_equal(focuser.getCurrentPosition(), 600U, "GP reports the reached target");
+}
+
+ZTEST(state_snapshot, test_remaining_time_tracks_motion)
+{
+	TimedStepper stepper;
+	Focuser focuser(stepper, nullptr, "eta");
+	zassert_ok(focuser.initialise(), "initialise precondition");
+
+	focuser.setNewPosition(600U);
+	focuser.goToNewPosition();
+	zassert_ok(focuser.run_once(K_NO_WAIT), "goto request should be handled");
+
+	/* Ask halfway through, then time how long the move really takes. */
+	while (stepper.position_now() < 300)
+	{
+		(void)focuser.run_once(K_NO_WAIT);
+		k_busy_wait(200);
+	}
+	const uint32_t estimate_ms = focuser.getRemainingMoveTime();
+	const int64_t asked = k_uptime_get();
+	while (focuser.isMoving())
+	{
+		(void)focuser.run_once(K_NO_WAIT);
+		k_busy_wait(200);
+	}
+	const uint32_t actual_ms = static_cast<uint32_t>(k_uptime_get() - asked);
+
+	TC_PRINT("halfway: estimated %u ms, took %u ms\n", estimate_ms, actual_ms);
+	/* Segment changes wait for the next completion poll, which the plan omits. */
+	zassert_true((estimate_ms + 5U >= actual_ms) && (actual_ms + 5U >= estimate_ms),
+		"estimate within 5 ms of the remaining time");
+}
+
+ZTEST(state_snapshot, test_benchmark_polling_contention)
+{
+	const PollResult mutex_result = poll_under_contention(false);
+	const PollResult seqlock_result = poll_under_contention(true);
+
+	TC_PRINT("%-8s %10s %8s %8s %18s\n", "reader", "reads", "writes", "torn",
+		 "max writer wait");
+	TC_PRINT("%-8s %10u %8u %8u %15u us\n", "mutex", mutex_result.reads, mutex_result.writes,
+		 mutex_result.torn, k_cyc_to_us_ceil32(mutex_result.writer_wait_cycles));
+	TC_PRINT("%-8s %10u %8u %8u %15u us\n", "seqlock", seqlock_result.reads,
+		 seqlock_result.writes, seqlock_result.torn,
+		 k_cyc_to_us_ceil32(seqlock_result.writer_wait_cycles));
+
+	zassert_equal(mutex_result.torn, 0U, "mutex reads must be consistent");
+	zassert_equal(seqlock_result.torn, 0U, "seqlock reads must be consistent");
+	zassert_true((mutex_result.writes > 0U) && (seqlock_result.writes > 0U),
+		"writer should have run alongside the reader");
+}
+
+ZTEST_SUITE(state_snapshot, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,336 @@
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <zephyr/drivers/stepper/stepper_fake.h>
+#include <zephyr/fff.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "Configuration.hpp"
+#include "Focuser.hpp"
+#include "UartHandler.hpp"
+#include "UartThread.hpp"
+#include "ZephyrStepper.hpp"
+
+namespace
+{
+
+/* One 8N1 character at 9600 baud occupies ten bit times. */
+constexpr uint32_t kCharTimeUs = (10U * 1000000U) / 9600U;
+constexpr size_t kEmulTxFifoSize = DT_PROP(DT_CHOSEN(focuser_uart), tx_fifo_size);
+
+ZephyrFocuserStepper g_stepper(config::devices::stepper, config::devices::stepper_drv);
+Focuser g_focuser(g_stepper, nullptr, "uart-test");
+UartHandler g_uart_handler(config::devices::uart);
+UartThread g_uart_thread(g_focuser, g_uart_handler);
+
+volatile uint32_t g_stop_cycles;
+volatile size_t g_tx_pending_at_stop;
+
+void inject(const char *data, size_t length)
+{
+	uart_emul_put_rx_data(config::devices::uart, reinterpret_cast<const uint8_t *>(data),
+			      length);
+}
+
+void inject(const char *frames)
+{
+	inject(frames, std::strlen(frames));
+}
+
+/* Collect transmitted bytes until `expected` arrived or the timeout expires. */
+size_t collect_tx(char *buffer, size_t expected, int timeout_ms)
+{
+	size_t received = 0U;
+	const int64_t deadline = k_uptime_get() + timeout_ms;
+	while ((received < expected) && (k_uptime_get() < deadline))
+	{
+		received += uart_emul_get_tx_data(config::devices::uart,
+						  reinterpret_cast<uint8_t *>(&buffer[received]),
+						  expected - received);
+		k_msleep(1);
+	}
+	return received;
+}
+
+/* Fills the emulated TX FIFO, which only drains when the test collects it,
+ * so nothing written afterwards can leave the handler's TX ring: a line
+ * that is still busy. Returns the number of filler bytes to collect.
+ */
+size_t stall_line()
+{
+	static const char filler[kEmulTxFifoSize] = {};
+	g_uart_handler.write(filler, sizeof(filler));
+	const int64_t deadline = k_uptime_get() + 200;
+	while ((g_uart_handler.tx_pending() > 0U) && (k_uptime_get() < deadline))
+	{
+		k_msleep(1);
+	}
+	zassert_equal(g_uart_handler.tx_pending(), 0U, "filler handed to the emulated line");
+	return sizeof(filler);
+}
+
+/* Drains the filler queued by stall_line(). */
+void release_line(size_t filler)
+{
+	static char sink[kEmulTxFifoSize];
+	zassert_equal(collect_tx(sink, filler, 200), filler, "filler transmitted");
+}
+
+bool wait_for_stop(int timeout_ms)
+{
+	const int64_t deadline = k_uptime_get() + timeout_ms;
+	while ((g_stop_cycles == 0U) && (k_uptime_get() < deadline))
+	{
+		k_usleep(100);
+	}
+	return g_stop_cycles != 0U;
+}
+
+bool wait_for_baud_rate(uint32_t baud, int timeout_ms)
+{
+	const int64_t deadline = k_uptime_get() + timeout_ms;
+	while ((g_uart_handler.baud_rate() != baud) && (k_uptime_get() < deadline))
+	{
+		k_msleep(1);
+	}
+	return g_uart_handler.baud_rate() == baud;
+}
+
+/* Sends an XB request and checks it is acknowledged before the switch. */
+void request_baud_rate(const char *frame, uint32_t baud)
+{
+	const uint32_t previous = g_uart_handler.baud_rate();
+	inject(frame);
+
+	char ack[4] = {};
+	zassert_equal(collect_tx(ack, 3U, 200), 3U, "%s acknowledged", frame);
+	zassert_mem_equal(ack, "01#", 3U, "%s accepted", frame);
+	zassert_true(wait_for_baud_rate(baud, 200), "switch to %u baud after the reply (from %u)",
+		     baud, previous);
+}
+
+void *uart_pipeline_setup(void)
+{
+	zassert_ok(g_uart_handler.init(), "UART handler init");
+	zassert_ok(g_focuser.initialise(), "focuser init");
+	g_uart_thread.start();
+	return nullptr;
+}
+
+void uart_pipeline_before(void *)
+{
+	uart_emul_flush_rx_data(config::devices::uart);
+	uart_emul_flush_tx_data(config::devices::uart);
+	g_stop_cycles = 0U;
+	g_tx_pending_at_stop = 0U;
+	fake_stepper_stop_fake.custom_fake = [](const struct device *) {
+		g_stop_cycles = k_cycle_get_32();
+		g_tx_pending_at_stop = g_uart_handler.tx_pending();
+		return 0;
+	};
+}
+
+} // namespace
+
+ZTEST(uart_pipeline, test_write_returns_before_transmission)
+{
+	static const char payload[] = "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF";
+	const size_t length = sizeof(payload) - 1U;
+	const size_t filler = stall_line();
+
+	const uint32_t start = k_cycle_get_32();
+	g_uart_handler.write(payload, length);
+	const uint32_t elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	const size_t pending = g_uart_handler.tx_pending();
+
+	TC_PRINT("write() of %u bytes returned after %u us with %u byte(s) still queued\n",
+		 static_cast<unsigned int>(length), elapsed_us, static_cast<unsigned int>(pending));
+	/* A write that waited for the line could not return until it was free. */
+	zassert_equal(pending, length, "write() should return with the payload queued");
+	zassert_true(elapsed_us < kCharTimeUs, "write() should not wait for the line");
+
+	release_line(filler);
+	char sent[sizeof(payload)] = {};
+	zassert_equal(collect_tx(sent, length, 200), length, "all bytes transmitted");
+	zassert_mem_equal(sent, payload, length, "bytes transmitted in order");
+}
+
+ZTEST(uart_pipeline, test_next_command_parsed_while_response_transmits)
+{
+	const size_t filler = stall_line();
+	inject(":GP#");
+	const int64_t deadline = k_uptime_get() + 200;
+	while ((g_uart_handler.tx_pending() == 0U) && (k_uptime_get() < deadline))
+	{
+		k_msleep(1);
+	}
+	zassert_equal(g_uart_handler.tx_pending(), 5U, "GP response queued behind the busy line");
+
+	inject(":FQ#");
+	zassert_true(wait_for_stop(200), "FQ after GP was never parsed");
+	TC_PRINT("FQ parsed with %u byte(s) of the GP response still queued\n",
+		 static_cast<unsigned int>(g_tx_pending_at_stop));
+	zassert_equal(g_tx_pending_at_stop, 5U,
+		      "FQ should be parsed before the GP response leaves");
+
+	release_line(filler);
+	char response[6] = {};
+	zassert_equal(collect_tx(response, 5U, 200), 5U, "GP response transmitted");
+	zassert_mem_equal(response, "0000#", 5U, "GP response content");
+}
+
+ZTEST(uart_pipeline, test_pipelined_burst_answers_every_frame_in_order)
+{
+	static const char *const frames[] = {":GP#", ":GN#", ":GD#", ":GH#",
+					     ":GI#", ":GT#", ":GC#", ":XS#"};
+	static const size_t response_lengths[] = {5U, 5U, 3U, 3U, 3U, 5U, 3U, 15U};
+	char sequential[64] = {};
+	char pipelined[64] = {};
+	char burst[64] = {};
+	size_t expected = 0U;
+
+	/* One frame per round trip, as a stock client polls. */
+	for (size_t i = 0; i < ARRAY_SIZE(frames); ++i)
+	{
+		inject(frames[i]);
+		zassert_equal(collect_tx(&sequential[expected], response_lengths[i], 200),
+			response_lengths[i], "response to %s", frames[i]);
+		expected += response_lengths[i];
+		std::strcat(burst, frames[i]);
+	}
+
+	/* The same frames in one write. */
+	const std::uint32_t writes_before = g_uart_handler.tx_writes();
+	inject(burst);
+	zassert_equal(collect_tx(pipelined, expected, 200), expected, "all responses transmitted");
+	const std::uint32_t writes = g_uart_handler.tx_writes() - writes_before;
+
+	TC_PRINT("%u frames answered in %u TX write(s)\n",
+		 static_cast<unsigned int>(ARRAY_SIZE(frames)), writes);
+	zassert_mem_equal(pipelined, sequential, expected, "responses must keep frame order");
+	zassert_true(writes < ARRAY_SIZE(frames), "responses should be batched");
+}
+
+ZTEST(uart_pipeline, test_baud_switch_falls_back_without_host)
+{
+	zassert_equal(g_uart_handler.baud_rate(), 9600U, "link starts at the Moonlite rate");
+	request_baud_rate(":XB04#", 115200U);
+
+	/* The host never follows, so no frame arrives at the new rate. */
+	k_msleep(CONFIG_APP_UART_BAUD_FALLBACK_MS + 50);
+	zassert_equal(g_uart_handler.baud_rate(), 9600U, "link should fall back to 9600 baud");
+
+	char response[6] = {};
+	inject(":GP#");
+	zassert_equal(collect_tx(response, 5U, 200), 5U, "link works after the fallback");
+}
+
+ZTEST(uart_pipeline, test_baud_switch_ignores_stale_and_unknown_frames)
+{
+	/* GP was sent with the XB, before the switch, so its answer is no proof. */
+	inject(":XB04#:GP#");
+	char replies[9] = {};
+	zassert_equal(collect_tx(replies, 8U, 200), 8U, "XB and GP answered");
+	zassert_mem_equal(replies, "01#", 3U, "XB accepted");
+	zassert_true(wait_for_baud_rate(115200U, 200), "switch to 115200 baud");
+
+	/* A frame the parser does not know is no proof either. */
+	inject(":ZZ#");
+
+	k_msleep(CONFIG_APP_UART_BAUD_FALLBACK_MS + 50);
+	zassert_equal(g_uart_handler.baud_rate(), 9600U, "link should fall back to 9600 baud");
+}
+
+ZTEST(uart_pipeline, test_baud_switch_sticks_once_host_follows)
+{
+	request_baud_rate(":XB06#", 460800U);
+
+	char response[6] = {};
+	inject(":GP#");
+	zassert_equal(collect_tx(response, 5U, 200), 5U, "GP answered at the new rate");
+
+	k_msleep(CONFIG_APP_UART_BAUD_FALLBACK_MS + 50);
+	zassert_equal(g_uart_handler.baud_rate(), 460800U, "confirmed rate is kept");
+
+	request_baud_rate(":XB00#", 9600U);
+	inject(":GP#");
+	zassert_equal(collect_tx(response, 5U, 200), 5U, "GP answered back at 9600 baud");
+
+	char refused[4] = {};
+	inject(":XB7F#");
+	zassert_equal(collect_tx(refused, 3U, 200), 3U, "unknown rate answered");
+	zassert_mem_equal(refused, "00#", 3U, "unknown rate refused");
+}
+
+ZTEST(uart_pipeline, test_wakeups_per_frame)
+{
+	static const char frame[] = ":SN1234#";
+	const std::uint32_t wakeups_before = g_uart_handler.rx_wakeups();
+	const std::uint32_t frames_before = g_uart_handler.rx_frames();
+
+	/* Deliver one byte per interrupt, as a slow host link would. */
+	for (size_t i = 0; i < sizeof(frame) - 1U; ++i)
+	{
+		inject(&frame[i], 1U);
+		k_msleep(2);
+	}
+
+	const std::uint32_t wakeups = g_uart_handler.rx_wakeups() - wakeups_before;
+	const std::uint32_t frames = g_uart_handler.rx_frames() - frames_before;
+
+	TC_PRINT("%s: %u wakeup(s) for %u frame(s)\n", frame, wakeups, frames);
+	zassert_equal(frames, 1U, "ISR should count exactly one frame");
+	if (IS_ENABLED(CONFIG_APP_UART_FRAME_WAKEUP))
+	{
+		zassert_equal(wakeups, 1U, "reader should wake once per frame");
+	}
+	else
+	{
+		zassert_equal(wakeups, sizeof(frame) - 1U, "reader should wake once per byte");
+	}
+}
+
+ZTEST(uart_pipeline, test_notifications_are_opt_in_and_never_split_responses)
+{
+	/* Moves to where the controller already is complete at once. */
+	RESET_FAKE(fake_stepper_get_actual_position);
+	RESET_FAKE(fake_stepper_move_to);
+	char expected[moonlite::kNotificationLength + 1] = {};
+	moonlite::writeNotification(expected, moonlite::Notification::move_completed, 0x0000);
+
+	/* Legacy clients never see a notification. */
+	g_focuser.setNewPosition(0x0000);
+	g_focuser.goToNewPosition();
+	zassert_ok(g_focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	char unsolicited[moonlite::kNotificationLength] = {};
+	zassert_equal(collect_tx(unsolicited, sizeof(unsolicited), 50), 0U,
+		"nothing is sent before XN01");
+
+	/* The notification races the GP response; both must arrive whole. */
+	inject(":XN01#:GP#");
+	k_msleep(5);
+	g_focuser.goToNewPosition();
+	zassert_ok(g_focuser.run_once(K_NO_WAIT), "goto request should be handled");
+
+	char sent[moonlite::kNotificationLength + 5U + 1U] = {};
+	zassert_equal(collect_tx(sent, sizeof(sent) - 1U, 200), sizeof(sent) - 1U,
+		"GP response and notification transmitted");
+	TC_PRINT("TX with notification: %s\n", sent);
+	const bool notification_first = (sent[0] == '!');
+	const char *notification = notification_first ? sent : &sent[5];
+	const char *response = notification_first ? &sent[moonlite::kNotificationLength] : sent;
+	zassert_mem_equal(notification, expected, moonlite::kNotificationLength,
+		"move-complete notification intact");
+	zassert_equal(response[4], '#', "GP response intact");
+
+	inject(":XN00#");
+	k_msleep(5);
+	g_focuser.goToNewPosition();
+	zassert_ok(g_focuser.run_once(K_NO_WAIT), "goto request should be handled");
+	zassert_equal(collect_tx(unsolicited, sizeof(unsolicited), 50), 0U,
+		"XN00 turns notifications off again");
+}
+
+ZTEST_SUITE(uart_pipeline, NULL, uart_pipeline_setup, uart_pipeline_before, NULL, NULL);
@@ -0,0 +1,138 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "WriteBehindPositionStore.hpp"
+
+namespace
+{
+
+/* Short idle delay so the suite runs quickly. */
+constexpr int32_t kIdleDelayMs = 50;
+/* Emulated flash erase/program time of one backing write. */
+constexpr uint32_t kBackingWriteUs = 20000U;
+
+K_THREAD_STACK_DEFINE(g_queue_stack, 1024);
+k_work_q g_queue;
+
+class SlowPositionStore final : public PositionStore
+{
+public:
+	bool load(PersistentState &state_out) override
+	{
+		if (saves == 0U)
+		{
+			return false;
+		}
+		state_out = last_saved;
+		return true;
+	}
+
+	void save(const PersistentState &state) override
+	{
+		k_busy_wait(kBackingWriteUs);
+		last_saved = state;
+		++saves;
+	}
+
+	PersistentState last_saved{};
+	unsigned int saves{0U};
+};
+
+void *write_behind_setup(void)
+{
+	k_work_queue_start(&g_queue, g_queue_stack, K_THREAD_STACK_SIZEOF(g_queue_stack),
+			   K_PRIO_PREEMPT(7), nullptr);
+	return nullptr;
+}
+
+PersistentState at(uint16_t position)
+{
+	return PersistentState{.position = position};
+}
+
+} // namespace
+
+ZTEST(write_behind_store, test_save_does_not_wait_for_backing_write)
+{
+	SlowPositionStore backing;
+	WriteBehindPositionStore store(backing, g_queue, kIdleDelayMs);
+
+	const uint32_t start = k_cycle_get_32();
+	store.save(at(0x1234));
+	const uint32_t elapsed_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+	TC_PRINT("save() returned after %u us (backing write takes %u us)\n", elapsed_us,
+		 kBackingWriteUs);
+	zassert_true(elapsed_us < (kBackingWriteUs / 10U), "save() should only queue the write");
+	zassert_equal(backing.saves, 0U, "backing write should be deferred");
+
+	store.flush();
+	zassert_equal(backing.saves, 1U, "flush should write the pending position");
+}
+
+ZTEST(write_behind_store, test_saves_coalesce_to_latest_position)
+{
+	SlowPositionStore backing;
+	WriteBehindPositionStore store(backing, g_queue, kIdleDelayMs);
+
+	store.save(at(1U));
+	store.save(at(2U));
+	store.save(at(3U));
+	k_msleep(kIdleDelayMs / 2);
+	zassert_equal(backing.saves, 0U, "nothing written before the idle delay");
+
+	k_msleep(kIdleDelayMs + 50);
+	zassert_equal(backing.saves, 1U, "a burst of saves should cost one write");
+	zassert_equal(backing.last_saved.position, 3U, "only the latest position is written");
+	zassert_equal(store.backing_writes(), 1U, "write counter");
+}
+
+ZTEST(write_behind_store, test_writes_wait_for_motion_to_end)
+{
+	SlowPositionStore backing;
+	WriteBehindPositionStore store(backing, g_queue, kIdleDelayMs);
+
+	store.set_motion_active(true);
+	store.save(at(0x0100));
+	k_msleep(3 * kIdleDelayMs);
+	zassert_equal(backing.saves, 0U, "no flash writes while moving");
+
+	store.set_motion_active(false);
+	k_msleep(kIdleDelayMs / 2);
+	zassert_equal(backing.saves, 0U, "idle timer restarts when motion ends");
+
+	k_msleep(kIdleDelayMs + 50);
+	zassert_equal(backing.saves, 1U, "pending position written once idle");
+	zassert_equal(backing.last_saved.position, 0x0100, "written position");
+}
+
+ZTEST(write_behind_store, test_load_prefers_pending_position)
+{
+	SlowPositionStore backing;
+	WriteBehindPositionStore store(backing, g_queue, kIdleDelayMs);
+	PersistentState loaded{};
+
+	zassert_false(store.load(loaded), "empty backing store has nothing to load");
+
+	store.save(at(0x4242));
+	zassert_true(store.load(loaded), "pending position should be visible");
+	zassert_equal(loaded.position, 0x4242, "pending position value");
+
+	store.flush();
+	zassert_equal(backing.saves, 1U, "flush writes through");
+	zassert_true(store.load(loaded), "written position should load from backing");
+	zassert_equal(loaded.position, 0x4242, "backing position value");
+}
+
+ZTEST(write_behind_store, test_flush_without_pending_write_is_noop)
+{
+	SlowPositionStore backing;
+	WriteBehindPositionStore store(backing, g_queue, kIdleDelayMs);
+
+	store.flush();
+	zassert_equal(backing.saves, 0U, "nothing to write");
+}
+
+ZTEST_SUITE(write_behind_store, NULL, write_behind_setup, NULL, NULL, NULL);
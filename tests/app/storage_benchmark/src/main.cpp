@@ -0,0 +1,139 @@
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash/flash_simulator.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "EepromPositionStore.hpp"
+#include "SettingsPositionStore.hpp"
+
+namespace
+{
+
+constexpr uint32_t kSaves = 10000U;
+constexpr size_t kEraseUnit = DT_PROP(DT_NODELABEL(sim_flash), erase_block_size);
+
+const struct device *const k_flash = DEVICE_DT_GET(DT_NODELABEL(sim_flash_controller));
+
+uint32_t g_erases;
+
+/* Performs the erase the simulator would have done and counts it. */
+int32_t count_erase(const struct device *dev, off_t unit_offset)
+{
+	size_t size = 0U;
+	auto *memory = static_cast<uint8_t *>(flash_simulator_get_memory(dev, &size));
+	std::memset(&memory[unit_offset], 0xFF, kEraseUnit);
+	++g_erases;
+	return 0;
+}
+
+flash_simulator_cb g_flash_callbacks{};
+
+struct BackendResult
+{
+	uint32_t save_mean_us{0U};
+	uint32_t save_max_us{0U};
+	uint32_t load_us{0U};
+	uint32_t erases{0U};
+};
+
+PersistentState state_for(uint32_t save)
+{
+	return PersistentState{
+		.position = static_cast<uint16_t>(save * 37U),
+		.speed_multiplier = static_cast<uint8_t>(1U + (save % 8U)),
+	};
+}
+
+/* Saves kSaves distinct states through `store`, then times the load a fresh
+ * instance from `reboot` performs at boot.
+ */
+BackendResult run_backend(PositionStore &store, PositionStore &reboot)
+{
+	BackendResult result;
+	PersistentState state{};
+	(void)store.load(state);
+
+	uint64_t total_cycles = 0U;
+	uint32_t max_cycles = 0U;
+	g_erases = 0U;
+	for (uint32_t i = 0; i < kSaves; ++i)
+	{
+		const uint32_t start = k_cycle_get_32();
+		store.save(state_for(i));
+		const uint32_t cycles = k_cycle_get_32() - start;
+		total_cycles += cycles;
+		if (cycles > max_cycles)
+		{
+			max_cycles = cycles;
+		}
+	}
+	result.erases = g_erases;
+	result.save_mean_us = k_cyc_to_us_ceil32(static_cast<uint32_t>(total_cycles / kSaves));
+	result.save_max_us = k_cyc_to_us_ceil32(max_cycles);
+
+	const uint32_t start = k_cycle_get_32();
+	const bool loaded = reboot.load(state);
+	result.load_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+	zassert_true(loaded, "state should load after %u saves", kSaves);
+	zassert_true(state == state_for(kSaves - 1U), "newest state should be loaded");
+	return result;
+}
+
+void print_result(const char *name, const BackendResult &result)
+{
+	TC_PRINT("%-10s %14u %14u %14u %16u\n", name, result.save_mean_us, result.save_max_us,
+		 result.load_us, result.erases);
+}
+
+void *storage_benchmark_setup(void)
+{
+	zassert_true(device_is_ready(k_flash), "flash simulator not ready");
+	g_flash_callbacks.erase_unit = count_erase;
+	flash_simulator_set_callbacks(k_flash, &g_flash_callbacks);
+	return nullptr;
+}
+
+} // namespace
+
+ZTEST(storage_benchmark, test_settings_store_round_trip)
+{
+	const PersistentState saved{
+		.position = 0x1234U,
+		.speed_multiplier = 2U,
+		.half_step = true,
+		.temperature_coeff_times2 = 5,
+	};
+
+	SettingsPositionStore store("focuser/round_trip");
+	store.save(saved);
+
+	SettingsPositionStore rebooted("focuser/round_trip");
+	PersistentState loaded{};
+	zassert_true(rebooted.load(loaded), "state should load from settings");
+	zassert_true(loaded == saved, "every field survives the reboot");
+}
+
+ZTEST(storage_benchmark, test_benchmark_backends)
+{
+	EepromPositionStore eeprom;
+	EepromPositionStore eeprom_reboot;
+	const BackendResult eeprom_result = run_backend(eeprom, eeprom_reboot);
+
+	SettingsPositionStore settings;
+	SettingsPositionStore settings_reboot;
+	const BackendResult settings_result = run_backend(settings, settings_reboot);
+
+	TC_PRINT("%u saves per backend, %u byte flash erase unit\n", kSaves,
+		 static_cast<unsigned int>(kEraseUnit));
+	TC_PRINT("%-10s %14s %14s %14s %16s\n", "backend", "save avg [us]", "save max [us]",
+		 "boot load [us]", "erases per 10k");
+	print_result("eeprom", eeprom_result);
+	print_result("settings", settings_result);
+}
+
+ZTEST_SUITE(storage_benchmark, NULL, storage_benchmark_setup, NULL, NULL, NULL);
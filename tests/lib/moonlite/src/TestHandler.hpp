@@ -0,0 +1,158 @@
+#pragma once
+
+#include <Moonlite.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/* Records every call made by the parser so tests can assert on dispatch. */
+class TestHandler : public moonlite::Handler
+{
+public:
+	void stop() override
+	{
+		stop_called = true;
+	}
+
+	uint16_t getCurrentPosition() override
+	{
+		return current_position;
+	}
+
+	void setCurrentPosition(uint16_t position) override
+	{
+		set_current_position_value = position;
+	}
+
+	uint16_t getNewPosition() override
+	{
+		return new_position;
+	}
+
+	void setNewPosition(uint16_t position) override
+	{
+		new_position = position;
+	}
+
+	void goToNewPosition() override
+	{
+		go_called = true;
+	}
+
+	bool isHalfStep() override
+	{
+		return half_step;
+	}
+
+	void setHalfStep(bool enabled) override
+	{
+		half_step = enabled;
+	}
+
+	bool isMoving() override
+	{
+		return moving;
+	}
+
+	std::string_view getFirmwareVersion() override
+	{
+		return firmware_version;
+	}
+
+	uint8_t getSpeed() override
+	{
+		return speed;
+	}
+
+	void setSpeed(uint8_t value) override
+	{
+		speed = value;
+	}
+
+	uint16_t getTemperature() override
+	{
+		return temperature;
+	}
+
+	uint8_t getTemperatureCoefficientRaw() override
+	{
+		return temperature_coefficient;
+	}
+
+	moonlite::Status getStatus() override
+	{
+		return status_override.has_value() ? *status_override : moonlite::Handler::getStatus();
+	}
+
+	void setNotifications(bool enabled) override
+	{
+		notifications = enabled;
+	}
+
+	bool setBaudRate(uint32_t baud) override
+	{
+		requested_baud = baud;
+		return baud <= max_baud;
+	}
+
+	uint32_t getRemainingMoveTime() override
+	{
+		return remaining_ms;
+	}
+
+	void clearProgram() override
+	{
+		program.clear();
+		program_dwell = 0U;
+	}
+
+	void setProgramDwell(uint16_t dwell_ms) override
+	{
+		program_dwell = dwell_ms;
+	}
+
+	void addProgramPoint(uint16_t position) override
+	{
+		program.push_back({position, program_dwell});
+	}
+
+	void runProgram() override
+	{
+		program_started = true;
+	}
+
+	uint32_t getProgramPointTime(uint8_t index) override
+	{
+		return (index < program.size()) ? (1000U + index) : 0U;
+	}
+
+	void jog(int16_t rate) override
+	{
+		jog_rates.push_back(rate);
+	}
+
+	bool stop_called{false};
+	bool go_called{false};
+	bool half_step{false};
+	bool moving{false};
+	bool notifications{false};
+	uint16_t current_position{0x1234};
+	uint16_t new_position{0x2345};
+	uint16_t set_current_position_value{0xFFFF};
+	uint8_t speed{0x22};
+	uint16_t temperature{0x3456};
+	uint8_t temperature_coefficient{0x77};
+	std::string firmware_version{"FW"};
+	std::optional<moonlite::Status> status_override{};
+	uint32_t requested_baud{0U};
+	uint32_t max_baud{115200U};
+	uint32_t remaining_ms{0U};
+	std::vector<std::pair<uint16_t, uint16_t>> program{};
+	uint16_t program_dwell{0U};
+	bool program_started{false};
+	std::vector<int16_t> jog_rates{};
+};
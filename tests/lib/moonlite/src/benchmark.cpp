@@ -0,0 +1,227 @@
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <Moonlite.hpp>
+
+#include <cstring>
+#include <initializer_list>
+
+#include "TestHandler.hpp"
+
+namespace
+{
+
+/* Typical host polling traffic mixed with a move request. */
+constexpr char kTraffic[] = ":GP#:GI#:SN1234#:FG#:GI#:GP#:GD#:GH#";
+constexpr size_t kTrafficLen = sizeof(kTraffic) - 1U;
+constexpr size_t kTrafficFrames = 8U;
+constexpr int kRounds = 200;
+
+/* A handler the compiler can prove is the dynamic type, as Focuser is in firmware. */
+class FinalTestHandler final : public TestHandler
+{
+};
+
+template <typename ParserT>
+uint32_t feed_per_byte(ParserT &parser, char *out, size_t &out_len)
+{
+	char response[moonlite::kMaxResponseLength];
+	out_len = 0U;
+
+	const uint32_t start = k_cycle_get_32();
+	for (int round = 0; round < kRounds; ++round)
+	{
+		out_len = 0U;
+		for (size_t i = 0; i < kTrafficLen; ++i)
+		{
+			size_t len = 0U;
+			if (parser.feed(kTraffic[i], response, len) && (len > 0U))
+			{
+				std::memcpy(out + out_len, response, len);
+				out_len += len;
+			}
+		}
+	}
+	return k_cycle_get_32() - start;
+}
+
+template <typename ParserT>
+uint32_t feed_bulk(ParserT &parser, char *out, size_t out_size, size_t &out_len)
+{
+	out_len = 0U;
+
+	const uint32_t start = k_cycle_get_32();
+	for (int round = 0; round < kRounds; ++round)
+	{
+		out_len = parser.feed(kTraffic, kTrafficLen, std::span<char>(out, out_size)).responseLength;
+	}
+	return k_cycle_get_32() - start;
+}
+
+struct PollCost
+{
+	size_t round_trips{0U};
+	size_t request_bytes{0U};
+	size_t response_bytes{0U};
+
+	size_t total() const
+	{
+		return request_bytes + response_bytes;
+	}
+};
+
+/* Runs one polling cycle, a request/response round trip per frame. */
+PollCost poll_cost(moonlite::Parser &parser, std::initializer_list<const char *> frames)
+{
+	PollCost cost;
+	char response[moonlite::kMaxResponseLength];
+	for (const char *frame : frames)
+	{
+		const size_t length = std::strlen(frame);
+		cost.request_bytes += length;
+		cost.response_bytes += parser.feed(frame, length, response).responseLength;
+		++cost.round_trips;
+	}
+	return cost;
+}
+
+void report(const char *label, const PollCost &cost)
+{
+	TC_PRINT("%-22s %5u %9u %9u %7u\n", label, static_cast<unsigned int>(cost.round_trips),
+		 static_cast<unsigned int>(cost.request_bytes),
+		 static_cast<unsigned int>(cost.response_bytes), static_cast<unsigned int>(cost.total()));
+}
+
+void report(const char *label, uint32_t cycles)
+{
+	const uint64_t bytes = static_cast<uint64_t>(kTrafficLen) * kRounds;
+	const uint64_t ns = k_cyc_to_ns_floor64(cycles);
+	TC_PRINT("%-9s %8u cycles, %4u cycles/byte, %8u bytes/s\n", label, cycles,
+		 static_cast<unsigned int>(cycles / bytes),
+		 static_cast<unsigned int>((ns == 0U) ? 0U : (bytes * 1000000000ULL) / ns));
+}
+
+} // namespace
+
+ZTEST(moonlite_benchmark, test_per_byte_vs_bulk_feed_throughput)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	char per_byte_out[8U * moonlite::kMaxResponseLength];
+	char bulk_out[8U * moonlite::kMaxResponseLength];
+	size_t per_byte_len = 0U;
+	size_t bulk_len = 0U;
+
+	const uint32_t per_byte_cycles = feed_per_byte(parser, per_byte_out, per_byte_len);
+	const uint32_t bulk_cycles = feed_bulk(parser, bulk_out, sizeof(bulk_out), bulk_len);
+
+	TC_PRINT("Moonlite parser throughput, %u rounds of %u bytes\n", kRounds,
+		 static_cast<unsigned int>(kTrafficLen));
+	report("per-byte", per_byte_cycles);
+	report("bulk", bulk_cycles);
+
+	zassert_true(per_byte_len > 0U, "traffic should produce responses");
+	zassert_equal(bulk_len, per_byte_len, "bulk and per-byte responses differ in length");
+	zassert_mem_equal(bulk_out, per_byte_out, bulk_len, "bulk and per-byte responses differ");
+}
+
+ZTEST(moonlite_benchmark, test_virtual_vs_static_dispatch)
+{
+	TestHandler virtual_handler;
+	FinalTestHandler static_handler;
+	moonlite::Parser virtual_parser(virtual_handler);
+	moonlite::BasicParser<FinalTestHandler> static_parser(static_handler);
+	char virtual_out[8U * moonlite::kMaxResponseLength];
+	char static_out[8U * moonlite::kMaxResponseLength];
+	size_t virtual_len = 0U;
+	size_t static_len = 0U;
+
+	const uint32_t virtual_cycles =
+		feed_bulk(virtual_parser, virtual_out, sizeof(virtual_out), virtual_len);
+	const uint32_t static_cycles =
+		feed_bulk(static_parser, static_out, sizeof(static_out), static_len);
+
+	const uint32_t frames = kTrafficFrames * kRounds;
+	TC_PRINT("Moonlite dispatch cost, %u frames\n", frames);
+	TC_PRINT("virtual   %8u cycles, %4u cycles/frame\n", virtual_cycles, virtual_cycles / frames);
+	TC_PRINT("static    %8u cycles, %4u cycles/frame\n", static_cycles, static_cycles / frames);
+
+	zassert_equal(static_len, virtual_len, "static and virtual responses differ in length");
+	zassert_mem_equal(static_out, virtual_out, static_len, "static and virtual responses differ");
+	zassert_equal(static_handler.new_position, 0x1234, "static parser dispatched SN");
+	zassert_true(static_handler.go_called, "static parser dispatched FG");
+}
+
+ZTEST(moonlite_benchmark, test_status_polling_bandwidth)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+
+	const PollCost basic = poll_cost(parser, {":GP#", ":GI#", ":GT#"});
+	const PollCost full = poll_cost(parser, {":GP#", ":GN#", ":GI#", ":GH#", ":GT#"});
+	const PollCost status = poll_cost(parser, {":XS#"});
+
+	TC_PRINT("Moonlite bytes on the wire per polling cycle\n");
+	TC_PRINT("%-22s %5s %9s %9s %7s\n", "poll", "trips", "request", "response", "total");
+	report("GP+GI+GT", basic);
+	report("GP+GN+GI+GH+GT", full);
+	report("XS", status);
+
+	zassert_equal(status.response_bytes, moonlite::responseWidth(moonlite::ResponseShape::status),
+		"XS replies with one fixed-width frame");
+	zassert_true(status.round_trips * 3U <= basic.round_trips,
+		"XS should replace three round trips");
+	zassert_true(status.total() < basic.total(), "XS should undercut GP+GI+GT");
+	zassert_true(status.total() * 2U <= full.total(),
+		"XS should at least halve the bytes of the polls it replaces");
+}
+
+ZTEST(moonlite_benchmark, test_sweep_round_trips)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	static const char *const kPoints[] = {"0F00", "0F80", "1000", "1080", "1100",
+					      "1180", "1200", "1280", "1300"};
+	char frame[16];
+
+	/* Host-sequenced V-curve: stage and start each point, then poll GI once it
+	 * should be done (the best case; real clients poll several times).
+	 */
+	PollCost host;
+	for (const char *point : kPoints)
+	{
+		std::strcpy(frame, ":SN");
+		std::strcat(frame, point);
+		std::strcat(frame, "#:FG#");
+		const PollCost step = poll_cost(parser, {frame, ":GI#"});
+		host.round_trips += step.round_trips;
+		host.request_bytes += step.request_bytes;
+		host.response_bytes += step.response_bytes;
+	}
+
+	/* The same sweep uploaded as a program in one write. */
+	char upload[8U * (ARRAY_SIZE(kPoints) + 4U)] = ":XN01#:XC#:XW07D0#";
+	for (const char *point : kPoints)
+	{
+		std::strcat(upload, ":XA");
+		std::strcat(upload, point);
+		std::strcat(upload, "#");
+	}
+	std::strcat(upload, ":XP#");
+	PollCost program = poll_cost(parser, {upload});
+	/* The device reports back once per point instead of being polled. */
+	program.response_bytes += (ARRAY_SIZE(kPoints) + 1U) * moonlite::kNotificationLength;
+
+	TC_PRINT("Moonlite cost of a %u-point focus sweep\n",
+		 static_cast<unsigned int>(ARRAY_SIZE(kPoints)));
+	TC_PRINT("%-22s %5s %9s %9s %7s\n", "sweep", "trips", "request", "response", "total");
+	report("SN+FG, GI per point", host);
+	report("XA program + XP", program);
+
+	zassert_equal(handler.program.size(), ARRAY_SIZE(kPoints), "every point uploaded");
+	zassert_true(handler.program_started, "program started by the upload");
+	zassert_equal(program.round_trips, 1U, "one round trip per sweep");
+	zassert_equal(host.round_trips, 2U * ARRAY_SIZE(kPoints), "two round trips per point");
+}
+
+ZTEST_SUITE(moonlite_benchmark, NULL, NULL, NULL, NULL, NULL);
@@ -2,94 +2,40 @@
 
 #include <Moonlite.hpp>
 
-namespace
-{
-
-class TestHandler : public moonlite::Handler
-{
-public:
-	void stop() override
-	{
-		stop_called = true;
-	}
-
-	uint16_t getCurrentPosition() override
-	{
-		return current_position;
-	}
-
-	void setCurrentPosition(uint16_t position) override
-	{
-		set_current_position_value = position;
-	}
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
-	uint16_t getNewPosition() override
-	{
-		return new_position;
-	}
-
-	void setNewPosition(uint16_t position) override
-	{
-		new_position = position;
-	}
-
-	void goToNewPosition() override
-	{
-		go_called = true;
-	}
-
-	bool isHalfStep() override
-	{
-		return half_step;
-	}
+#include "TestHandler.hpp"
 
-	void setHalfStep(bool enabled) override
-	{
-		half_step = enabled;
-	}
-
-	bool isMoving() override
-	{
-		return moving;
-	}
+namespace
+{
 
-	std::string getFirmwareVersion() override
-	{
-		return firmware_version;
-	}
+/* Counts every global operator new so tests can prove a code path is heap-free. */
+std::atomic<unsigned int> g_allocation_count{0U};
 
-	uint8_t getSpeed() override
-	{
-		return speed;
-	}
+} // namespace
 
-	void setSpeed(uint8_t value) override
-	{
-		speed = value;
-	}
+void *operator new(std::size_t size)
+{
+	g_allocation_count.fetch_add(1U, std::memory_order_relaxed);
+	void *ptr = std::malloc((size == 0U) ? 1U : size);
+	__ASSERT(ptr != nullptr, "test heap exhausted");
+	return ptr;
+}
 
-	uint16_t getTemperature() override
-	{
-		return temperature;
-	}
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
 
-	uint8_t getTemperatureCoefficientRaw() override
-	{
-		return temperature_coefficient;
-	}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
 
-	bool stop_called{false};
-	bool go_called{false};
-	bool half_step{false};
-	bool moving{false};
-	uint16_t current_position{0x1234};
-	uint16_t new_position{0x2345};
-	uint16_t set_current_position_value{0xFFFF};
-	uint8_t speed{0x22};
-	uint16_t temperature{0x3456};
-	uint8_t temperature_coefficient{0x77};
-	std::string firmware_version{"FW"};
-};
+namespace
+{
 
 bool feed_frame(moonlite::Parser &parser, const char *frame, std::string &response)
 {
@@ -102,6 +48,23 @@ bool feed_frame(moonlite::Parser &parser, const char *frame, std::string &respon
 	return completed;
 }
 
+bool feed_frame(moonlite::Parser &parser, const char *frame, std::span<char> response,
+		size_t &response_len)
+{
+	response_len = 0;
+	bool completed = false;
+	for (const char *p = frame; *p != '\0'; ++p)
+	{
+		size_t len = 0;
+		completed = parser.feed(*p, response, len);
+		if (completed)
+		{
+			response_len = len;
+		}
+	}
+	return completed;
+}
+
 } // namespace
 
 ZTEST(moonlite_helpers, test_expected_payload_lengths)
@@ -114,6 +77,26 @@ ZTEST(moonlite_helpers, test_expected_payload_lengths)
 		"FQ payload length");
 }
 
+ZTEST(moonlite_helpers, test_command_table_lookup)
+{
+	for (const moonlite::CommandSpec &spec : moonlite::kCommandTable)
+	{
+		const char opcode[] = {static_cast<char>(spec.opcode >> 8),
+				       static_cast<char>(spec.opcode & 0xFF)};
+		zassert_equal(moonlite::strToCommandType(opcode), spec.type, "opcode %c%c decode",
+			opcode[0], opcode[1]);
+		zassert_equal(moonlite::expectedPayloadLength(spec.type), spec.payloadLength,
+			"opcode %c%c payload length", opcode[0], opcode[1]);
+	}
+
+	zassert_equal(moonlite::strToCommandType("SQ"), moonlite::CommandType::unrecognized,
+		"Unknown opcode sharing a prefix");
+	zassert_equal(moonlite::strToCommandType("QF"), moonlite::CommandType::unrecognized,
+		"Swapped opcode");
+	zassert_equal(moonlite::expectedPayloadLength(moonlite::CommandType::unrecognized), 0,
+		"Unknown command payload length");
+}
+
 ZTEST(moonlite_helpers, test_opcode_and_hex_helpers)
 {
 	zassert_equal(moonlite::strToCommandType("GP"), moonlite::CommandType::get_current_position,
@@ -127,6 +110,30 @@ ZTEST(moonlite_helpers, test_opcode_and_hex_helpers)
 	zassert_true(moonlite::hex4(0x0C3D) == "0C3D", "hex4 formatting");
 	zassert_equal(moonlite::parseHex2("ab"), 0xAB, "parseHex2 lowercase");
 	zassert_equal(moonlite::parseHex4("7fff"), 0x7FFF, "parseHex4 lowercase");
+
+	char buf[8];
+	zassert_equal(moonlite::writeHex2(buf, 0x5A), 2U, "writeHex2 length");
+	zassert_mem_equal(buf, "5A", 2, "writeHex2 formatting");
+	zassert_equal(moonlite::writeHex4(buf, 0xBEEF), 4U, "writeHex4 length");
+	zassert_mem_equal(buf, "BEEF", 4, "writeHex4 formatting");
+	zassert_equal(moonlite::writeHex8(buf, 0x0123ABCD), 8U, "writeHex8 length");
+	zassert_mem_equal(buf, "0123ABCD", 8, "writeHex8 formatting");
+}
+
+ZTEST(moonlite_helpers, test_notification_frames)
+{
+	char frame[moonlite::kNotificationLength];
+
+	zassert_equal(moonlite::writeNotification(frame, moonlite::Notification::move_completed,
+						  0x1A2B),
+		moonlite::kNotificationLength, "notification length");
+	zassert_mem_equal(frame, "!C1A2B#", sizeof(frame), "completed notification");
+
+	moonlite::writeNotification(frame, moonlite::Notification::move_cancelled, 0x0010);
+	zassert_mem_equal(frame, "!Q0010#", sizeof(frame), "cancelled notification");
+
+	moonlite::writeNotification(frame, moonlite::Notification::move_failed, 0xFFFF);
+	zassert_mem_equal(frame, "!FFFFF#", sizeof(frame), "failed notification");
 }
 
 ZTEST(moonlite_parser, test_handles_query_commands)
@@ -167,6 +174,26 @@ ZTEST(moonlite_parser, test_handles_query_commands)
 	zassert_equal(response, std::string("EF#"), "GC response");
 }
 
+ZTEST(moonlite_parser, test_status_combines_polled_values)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	std::string response;
+
+	zassert_true(feed_frame(parser, ":XS#", response), "XS frame completion");
+	zassert_equal(response, std::string("123423453456" "00#"), "XS response at rest");
+
+	handler.moving = true;
+	handler.half_step = true;
+	handler.current_position = 0x00FF;
+	zassert_true(feed_frame(parser, ":XS#", response), "XS frame completion");
+	zassert_equal(response, std::string("00FF23453456" "03#"), "XS moving in half-step");
+
+	handler.status_override = moonlite::Status{0x0102, 0x0304, 0x0506, moonlite::kStatusFault};
+	zassert_true(feed_frame(parser, ":XS#", response), "XS frame completion");
+	zassert_equal(response, std::string("010203040506" "80#"), "XS served by getStatus()");
+}
+
 ZTEST(moonlite_parser, test_handles_state_changing_commands)
 {
 	TestHandler handler;
@@ -194,6 +221,114 @@ ZTEST(moonlite_parser, test_handles_state_changing_commands)
 
 	zassert_true(feed_frame(parser, ":FQ#", response), "FQ frame completion");
 	zassert_true(handler.stop_called, "FQ stopped focuser");
+
+	zassert_true(feed_frame(parser, ":XN01#", response), "XN frame completion");
+	zassert_true(handler.notifications, "XN01 enables notifications");
+	zassert_true(response.empty(), "XN has no response");
+
+	zassert_true(feed_frame(parser, ":XN00#", response), "XN frame completion");
+	zassert_false(handler.notifications, "XN00 disables notifications");
+}
+
+ZTEST(moonlite_parser, test_go_commands_stage_and_start_in_one_frame)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	std::string response;
+
+	zassert_true(feed_frame(parser, ":XG8000#", response), "XG frame completion");
+	zassert_equal(handler.new_position, 0x8000, "XG stages the target");
+	zassert_true(handler.go_called, "XG starts the move");
+	zassert_true(response.empty(), "XG has no response");
+
+	handler.go_called = false;
+	zassert_true(feed_frame(parser, ":XR0010#", response), "XR frame completion");
+	zassert_equal(handler.new_position, 0x1244, "XR counts from the current position");
+	zassert_true(handler.go_called, "XR starts the move");
+
+	zassert_true(feed_frame(parser, ":XRFFF0#", response), "XR frame completion");
+	zassert_equal(handler.new_position, 0x1224, "negative delta");
+
+	handler.current_position = 0x0005;
+	zassert_true(feed_frame(parser, ":XR8000#", response), "XR frame completion");
+	zassert_equal(handler.new_position, 0x0000, "clamped at zero");
+
+	handler.current_position = 0xFFF0;
+	zassert_true(feed_frame(parser, ":XR7FFF#", response), "XR frame completion");
+	zassert_equal(handler.new_position, 0xFFFF, "clamped at FFFF");
+}
+
+ZTEST(moonlite_parser, test_baud_rate_request_is_acknowledged)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	std::string response;
+
+	zassert_true(feed_frame(parser, ":XB04#", response), "XB frame completion");
+	zassert_equal(handler.requested_baud, 115200U, "XB04 selects 115200 baud");
+	zassert_equal(response, std::string("01#"), "accepted rate");
+
+	zassert_true(feed_frame(parser, ":XB06#", response), "XB frame completion");
+	zassert_equal(handler.requested_baud, 460800U, "XB06 selects 460800 baud");
+	zassert_equal(response, std::string("00#"), "handler refused the rate");
+
+	handler.requested_baud = 0U;
+	zassert_true(feed_frame(parser, ":XB07#", response), "XB frame completion");
+	zassert_equal(handler.requested_baud, 0U, "unknown index never reaches the handler");
+	zassert_equal(response, std::string("00#"), "unknown rate refused");
+}
+
+ZTEST(moonlite_parser, test_remaining_time_is_reported_in_milliseconds)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	std::string response;
+
+	zassert_true(feed_frame(parser, ":XE#", response), "XE frame completion");
+	zassert_equal(response, std::string("00000000#"), "idle handler reports no time left");
+
+	handler.remaining_ms = 0x0001D4C0;
+	zassert_true(feed_frame(parser, ":XE#", response), "XE frame completion");
+	zassert_equal(response, std::string("0001D4C0#"), "120 s left, beyond the hex4 range");
+}
+
+ZTEST(moonlite_parser, test_program_upload_reaches_handler)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	char response[4U * moonlite::kMaxResponseLength];
+
+	static const char upload[] = ":XC#:XA0100#:XW01F4#:XA0200#:XA0300#:XP#";
+	const moonlite::Parser::FeedResult result =
+		parser.feed(upload, sizeof(upload) - 1U, std::span<char>(response));
+	zassert_equal(result.frames, 6U, "whole upload parsed in one feed");
+	zassert_equal(result.responseLength, 0U, "the upload has no replies");
+	zassert_equal(handler.program.size(), 3U, "three points");
+	zassert_equal(handler.program[0].first, 0x0100, "first point");
+	zassert_equal(handler.program[0].second, 0U, "no dwell before XW");
+	zassert_equal(handler.program[1].second, 500U, "XW applies to later points");
+	zassert_equal(handler.program[2].second, 500U, "XW is sticky");
+	zassert_true(handler.program_started, "XP runs the program");
+
+	std::string reply;
+	zassert_true(feed_frame(parser, ":XT02#", reply), "XT frame completion");
+	zassert_equal(reply, std::string("000003EA#"), "XT reports the point's time");
+}
+
+ZTEST(moonlite_parser, test_jog_rate_is_signed)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	std::string response;
+
+	zassert_true(feed_frame(parser, ":XJ0190#", response), "XJ frame completion");
+	zassert_true(feed_frame(parser, ":XJFE70#", response), "XJ frame completion");
+	zassert_true(feed_frame(parser, ":XJ0000#", response), "XJ frame completion");
+	zassert_true(response.empty(), "XJ has no reply");
+	zassert_equal(handler.jog_rates.size(), 3U, "every keepalive reaches the handler");
+	zassert_equal(handler.jog_rates[0], 400, "outward rate");
+	zassert_equal(handler.jog_rates[1], -400, "inward rate");
+	zassert_equal(handler.jog_rates[2], 0, "zero rate stops");
 }
 
 ZTEST(moonlite_parser, test_rejects_invalid_payload)
@@ -208,5 +343,147 @@ ZTEST(moonlite_parser, test_rejects_invalid_payload)
 	zassert_true(response.empty(), "Invalid frame has no response");
 }
 
+ZTEST(moonlite_parser, test_overlong_payload_is_discarded)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	std::string response;
+
+	handler.new_position = 0x0101;
+	zassert_true(feed_frame(parser, ":SN123456789#", response), "Overlong frame still completes");
+	zassert_equal(handler.new_position, 0x0101, "Overlong payload ignored");
+	zassert_true(response.empty(), "Overlong frame has no response");
+
+	zassert_true(feed_frame(parser, ":SN4321#", response), "Parser recovers after overflow");
+	zassert_equal(handler.new_position, 0x4321, "Next frame applied");
+}
+
+ZTEST(moonlite_parser, test_span_feed_truncates_to_buffer)
+{
+	TestHandler handler;
+	handler.firmware_version = "0123456789ABCDEFGHIJ";
+	moonlite::Parser parser(handler);
+	char response[moonlite::kMaxResponseLength];
+	size_t response_len = 0;
+
+	zassert_true(feed_frame(parser, ":GV#", response, response_len), "GV frame completion");
+	zassert_equal(response_len, moonlite::kMaxFirmwareVersionLength, "GV clipped to maximum");
+	zassert_mem_equal(response, "0123456789ABCDEF", response_len, "GV prefix");
+
+	char small[3];
+	zassert_true(feed_frame(parser, ":GP#", small, response_len), "GP frame completion");
+	zassert_equal(response_len, sizeof(small), "GP clipped to caller buffer");
+	zassert_mem_equal(small, "123", sizeof(small), "GP prefix");
+}
+
+ZTEST(moonlite_parser, test_span_feed_is_heap_free)
+{
+	TestHandler handler;
+	handler.firmware_version = "FW-HEAP-FREE";
+	moonlite::Parser parser(handler);
+	char response[moonlite::kMaxResponseLength];
+	size_t response_len = 0;
+
+	static const char *const frames[] = {
+		":GP#", ":GI#", ":GN#", ":GH#", ":GV#", ":GD#", ":GT#", ":GC#",
+		":SP1234#", ":SNBEEF#", ":FG#", ":SF#", ":SH#", ":SD10#", ":FQ#", ":XS#", ":XN01#",
+		":XX#", ":SP12G#", ":SN123456789#",
+	};
+
+	const unsigned int before = g_allocation_count.load();
+	for (int round = 0; round < 10; ++round)
+	{
+		for (const char *frame : frames)
+		{
+			zassert_true(feed_frame(parser, frame, response, response_len),
+				"frame %s should complete", frame);
+		}
+	}
+	const unsigned int after = g_allocation_count.load();
+
+	zassert_equal(after, before, "span feed allocated %u times", after - before);
+	zassert_equal(handler.new_position, 0xBEEF, "frames were dispatched");
+}
+
+ZTEST(moonlite_parser, test_bulk_feed_emits_all_responses)
+{
+	TestHandler handler;
+	handler.moving = true;
+	moonlite::Parser parser(handler);
+	char response[4 * moonlite::kMaxResponseLength];
+
+	static const char burst[] = ":SNA0A0#:FG#:GI#:GN#:GP";
+	const auto result = parser.feed(burst, sizeof(burst) - 1U, response);
+
+	zassert_equal(result.consumed, sizeof(burst) - 1U, "whole burst consumed");
+	zassert_equal(result.frames, 4U, "four frames completed");
+	zassert_equal(result.recognized, 4U, "all four are known commands");
+	zassert_equal(result.responseLength, 8U, "GI and GN responses");
+	zassert_mem_equal(response, "01#A0A0#", result.responseLength, "responses in frame order");
+	zassert_equal(handler.new_position, 0xA0A0, "SN applied");
+	zassert_true(handler.go_called, "FG applied");
+
+	const auto tail = parser.feed("#", 1U, response);
+	zassert_equal(tail.frames, 1U, "frame split across bursts completes");
+	zassert_mem_equal(response, "1234#", tail.responseLength, "GP response");
+}
+
+ZTEST(moonlite_parser, test_bulk_feed_stops_when_response_space_runs_out)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	char response[moonlite::kMaxResponseLength + 6U];
+
+	static const char burst[] = ":GP#:GN#:GD#";
+	const auto first = parser.feed(burst, sizeof(burst) - 1U, response);
+
+	zassert_equal(first.frames, 2U, "third response would not fit");
+	zassert_equal(first.consumed, 11U, "stops on the pending terminator");
+	zassert_mem_equal(response, "1234#2345#", first.responseLength, "GP and GN responses");
+
+	const auto second = parser.feed(burst + first.consumed, sizeof(burst) - 1U - first.consumed,
+					response);
+	zassert_equal(second.consumed, 1U, "rest consumed");
+	zassert_equal(second.frames, 1U, "remaining frame completed");
+	zassert_mem_equal(response, "22#", second.responseLength, "GD response");
+}
+
+ZTEST(moonlite_parser, test_bulk_feed_counts_recognized_frames)
+{
+	TestHandler handler;
+	moonlite::Parser parser(handler);
+	char response[4 * moonlite::kMaxResponseLength];
+
+	/* Unknown opcode, short payload, non-hex payload, then one good frame. */
+	static const char burst[] = ":ZZ#:SN12#:SNXYZW#:GP#";
+	const auto result = parser.feed(burst, sizeof(burst) - 1U, response);
+
+	zassert_equal(result.frames, 4U, "every terminator completes a frame");
+	zassert_equal(result.recognized, 1U, "only GP is a valid command");
+	zassert_mem_equal(response, "1234#", result.responseLength, "GP response");
+}
+
+ZTEST(moonlite_parser, test_static_parser_matches_virtual_parser)
+{
+	TestHandler handler;
+	moonlite::BasicParser<TestHandler> parser(handler);
+	char response[4 * moonlite::kMaxResponseLength];
+
+	static const char burst[] = ":SP0102#:GP#:SD40#:GD#:SH#:GH#:GV#";
+	const auto result = parser.feed(burst, sizeof(burst) - 1U, response);
+
+	zassert_equal(result.frames, 7U, "all frames completed");
+	zassert_mem_equal(response, "1234#40#FF#FW", result.responseLength, "static responses");
+	zassert_equal(handler.set_current_position_value, 0x0102, "SP dispatched");
+}
+
+ZTEST(moonlite_helpers, test_allocation_counter_observes_new)
+{
+	const unsigned int before = g_allocation_count.load();
+	auto *probe = new std::string(64, 'x');
+	zassert_true(g_allocation_count.load() > before, "operator new should be counted");
+	delete probe;
+}
+
 ZTEST_SUITE(moonlite_helpers, NULL, NULL, NULL, NULL, NULL);
 ZTEST_SUITE(moonlite_parser, NULL, NULL, NULL, NULL, NULL);